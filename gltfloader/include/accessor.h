@@ -0,0 +1,37 @@
+#ifndef _ACCESSOR_HEADER_
+#define _ACCESSOR_HEADER_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tinygltf { class Model; }
+
+// A typed, possibly strided, view over raw accessor bytes.
+//   componentType is one of the TINYGLTF_COMPONENT_TYPE_* values.
+typedef struct AccessorView {
+    const unsigned char     *data;          // First element
+    size_t                  count;          // Number of elements
+    size_t                  stride;         // Bytes between elements
+    int                     componentType;
+    int                     components;     // Components per element (3 for VEC3 etc)
+    bool                    normalized;
+} AccessorView;
+
+int ComponentSize( int componentType );
+
+// Resolve accessor -> bufferView -> buffer. Fails on sparse or out of range accessors.
+bool GetAccessorView( const tinygltf::Model &model, int accessor, AccessorView *out );
+
+// Bytes the view reads, from data to the end of the last element
+size_t AccessorViewExtent( const AccessorView &view );
+
+// Convert to tightly packed values (count * components). Normalized integer
+// types are mapped to [0,1] / [-1,1] as the glTF spec describes.
+void ConvertToFloat( const AccessorView &view, float *out );
+void ConvertToU32( const AccessorView &view, uint32_t *out );
+void ConvertToU16( const AccessorView &view, uint16_t *out );
+
+// Source bytes converted by the calls above since the last call, from all threads
+uint64_t TakeConvertedBytes();
+
+#endif // _ACCESSOR_HEADER_
@@ -0,0 +1,60 @@
+#ifndef _ANIMATION_HEADER_
+#define _ANIMATION_HEADER_
+
+#include <stddef.h>
+#include <vector>
+
+namespace tinygltf { class Model; }
+
+// Floats per node in a pose: translation xyz, rotation xyzw, scale xyz
+#define ANIMATION_TRS_FLOATS    10
+
+enum AnimationPath
+{
+    ANIMATION_TRANSLATION   = 0,    // Float offsets into a node's pose
+    ANIMATION_ROTATION      = 3,
+    ANIMATION_SCALE         = 7,
+};
+
+enum AnimationInterpolation
+{
+    ANIMATION_LINEAR,
+    ANIMATION_STEP,
+    ANIMATION_CUBICSPLINE,
+};
+
+// One channel with its sampler converted to floats. Cubic spline keys are
+// in-tangent, value, out-tangent (3 * components floats). Tracks are read only
+// once built, so any number of characters can sample the same clip.
+typedef struct AnimationTrack {
+    int                 node;
+    int                 path;           // AnimationPath
+    int                 interpolation;  // AnimationInterpolation
+    int                 components;     // 3, 4 for rotations
+    std::vector<float>  times;
+    std::vector<float>  values;
+} AnimationTrack;
+
+typedef struct AnimationClip {
+    std::vector<AnimationTrack> tracks;
+    float                       duration;   // Time of the last key
+} AnimationClip;
+
+// One clip per model.animations entry. Morph target weights channels and channels
+// with broken accessors are left out.
+void BuildAnimationClips( const tinygltf::Model &model, std::vector<AnimationClip> &clips );
+
+// TRS of every node without animation (ANIMATION_TRS_FLOATS per node). Node
+// matrices are decomposed.
+void GetRestPose( const tinygltf::Model &model, std::vector<float> &pose );
+
+// Value of a track at time, clamped to its first and last key. cursor holds the
+// caller's key of the last sample (starts at 0): keys are found from it when time
+// moves forward, by binary search otherwise or when no cursor is passed (0).
+void SampleTrack( const AnimationTrack &track, float time, float *out, size_t *cursor );
+
+// Overwrites the animated nodes of pose (usually a copy of the rest pose).
+// cursors is one per track of the clip, owned by the character being posed, or 0.
+void SampleAnimation( const AnimationClip &clip, float time, float *pose, size_t nodes, size_t *cursors );
+
+#endif // _ANIMATION_HEADER_
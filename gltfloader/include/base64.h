@@ -0,0 +1,17 @@
+#ifndef _BASE64_HEADER_
+#define _BASE64_HEADER_
+
+#include <stddef.h>
+
+// Base64 decoding for the data uris of embedded buffers and images, 16 (SSE2)
+// or 64 (NEON) characters at a time. tiny_gltf.h's DecodeDataURI uses it to
+// decode straight into Buffer::data / Image::image.
+
+// Room the output needs for len characters of input
+size_t Base64DecodeBound( size_t len );
+
+// Decodes up to the first '=' or character outside the alphabet, the same rule
+// as tinygltf's base64_decode. Returns the number of bytes written to out.
+size_t Base64Decode( const char *in, size_t len, unsigned char *out );
+
+#endif // _BASE64_HEADER_
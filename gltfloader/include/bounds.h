@@ -0,0 +1,27 @@
+#ifndef _BOUNDS_HEADER_
+#define _BOUNDS_HEADER_
+
+#include <stddef.h>
+#include <vector>
+
+namespace tinygltf { class Model; struct Primitive; }
+
+typedef struct PrimitiveBounds {
+    float       min[3];
+    float       max[3];
+    bool        valid;
+} PrimitiveBounds;
+
+// Min/max of a float3 stream with the given byte stride (SIMD where available)
+void ReducePositionBounds( const unsigned char *data, size_t count, size_t stride, float *outmin, float *outmax );
+
+// Bounds of the POSITION accessor. Uses the accessor min/max when the file has them.
+bool ComputePrimitiveBounds( const tinygltf::Model &model, const tinygltf::Primitive &prim, PrimitiveBounds *out );
+
+// Fills bounds[mesh][primitive] for every mesh in the model
+void ComputeModelBounds( const tinygltf::Model &model, std::vector< std::vector<PrimitiveBounds> > &bounds );
+
+// Union of the valid bounds in the list. Returns false if none are valid.
+bool MergeBounds( const std::vector<PrimitiveBounds> &bounds, PrimitiveBounds *out );
+
+#endif // _BOUNDS_HEADER_
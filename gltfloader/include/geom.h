@@ -43,10 +43,20 @@ float dot(const Vec3 &a, const Vec3 &b);
 bool intersect( Ray ray, AABB aabb, float *distance);
 bool intersectOBB( Ray ray, OBB obb, float *distance);
 
+// Register a box with the raycast list, returns its index (as addboundingbox does)
+int AddBounds( Vec3 vmin, Vec3 vmax, uint64_t tag );
+void ClearBounds();
+// World transform of a registered box (as updateobb does)
+void SetBoundsWorld( int index, const dmVMath::Matrix4 &world );
+// Closest box hit by the ray, -1 for none (the raycasttobox loop)
+int RaycastBounds( const Ray &ray, float *closest );
+
 int AddBoundingBox(lua_State *L);
 OBB MultWorld( OBB obb );
 int RaycastToBox( lua_State *L);
 int UpdateOBB( lua_State *L );
 int PerlinNoise( lua_State *L );
 
+float perlin2d(float x, float y, float freq, int depth);
+
 #endif // _GEOM_HEADER_
@@ -0,0 +1,49 @@
+#ifndef _GLTF_PARSE_HEADER_
+#define _GLTF_PARSE_HEADER_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tinygltf { class Model; }
+
+// Flags for load_gltf (exposed to lua as gltfloader.LOAD_*)
+enum LoadFlags
+{
+    LOAD_LAZY_IMAGES    = 1,    // Keep images encoded until gltfloader.get_image asks for them
+    LOAD_NO_CACHE       = 2,    // Do not read or write baked files (gltfbake output or the cache)
+};
+
+// Where the time of a ParseGltf went, in microseconds
+typedef struct ParseStats {
+    uint64_t    total;
+    uint64_t    read;           // File reads: the .gltf/.glb itself, .bin buffers and image files
+    uint64_t    bytesread;
+} ParseStats;
+
+// Reads a whole model file (the .gltf/.glb, .bin buffers, image files) into out
+typedef bool (*GltfReadFileFunc)( const char *path, std::vector<unsigned char> *out, std::string *err, void *ctx );
+
+// Where ParseGltf gets its files from, 0 reads them from disk (ReadGltfFile).
+// The extension sets a reader for the resource system so bundled models load
+// from the game archive.
+void SetGltfFileReader( GltfReadFileFunc func, void *ctx );
+
+// The disk reader, for custom readers to fall back to
+bool ReadGltfFile( const char *path, std::vector<unsigned char> *out, std::string *err );
+
+// Reads with the reader set by SetGltfFileReader (the disk without one), the way
+// ParseGltf and the bake cache get every file
+bool ReadModelFile( const char *path, std::vector<unsigned char> *out, std::string *err );
+
+// The engine free part of load_gltf, also used by the tools. Reads the gltfbake
+// output next to the file, then the cache (GetRuntimeCachePath), whichever is up
+// to date first, otherwise parses the .gltf/.glb and writes the cache.
+// gltfbake output is found through the file reader, so bundles use the bakes they
+// ship. The cache is only used when the source is a file on disk (development runs
+// and the tools), never for models read from the game archive.
+// Images are left encoded (StageImageData), see DecodeImages. cached and stats can be 0.
+bool ParseGltf( const char *gltf_filename, uint32_t flags, tinygltf::Model &model,
+                std::string *err, std::string *warn, bool *cached, ParseStats *stats );
+
+#endif // _GLTF_PARSE_HEADER_
@@ -0,0 +1,31 @@
+#ifndef _GLTF_PROFILE_HEADER_
+#define _GLTF_PROFILE_HEADER_
+
+// Profiler scopes for the modules that also build into the tools (tools/gltfbake)
+// where there is no Defold SDK. Without it the scopes compile to nothing.
+#if defined(__has_include)
+#if __has_include(<dmsdk/sdk.h>)
+#define GLTF_HAVE_DMSDK
+#endif
+#endif
+
+#if defined(GLTF_HAVE_DMSDK)
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#define GLTF_PROFILE(name)      DM_PROFILE(name)
+
+// Counters under "glTF loader" in the profiler, defined in gltfloader.cpp
+DM_PROPERTY_EXTERN(rmtp_GltfLoader);
+DM_PROPERTY_EXTERN(rmtp_GltfBytesConverted);
+DM_PROPERTY_EXTERN(rmtp_GltfRaysTested);
+DM_PROPERTY_EXTERN(rmtp_GltfBoxesVisited);
+
+#else
+
+#define GLTF_PROFILE(name)
+
+#endif
+
+#endif // _GLTF_PROFILE_HEADER_
@@ -0,0 +1,21 @@
+#ifndef _IMAGE_DECODE_HEADER_
+#define _IMAGE_DECODE_HEADER_
+
+#include <string>
+
+// tiny_gltf.h is only included by the sources, it carries the implementation in tinygltf_loader.cpp
+namespace tinygltf { struct Image; class Model; }
+
+// Image loader hook for TinyGLTF::SetImageLoader. It only keeps the encoded
+// png/jpg bytes on the image (as_is) so the parse is not held up by decoding.
+bool StageImageData( tinygltf::Image *image, const int image_idx, std::string *err,
+                     std::string *warn, int req_width, int req_height,
+                     const unsigned char *bytes, int size, void *user_data );
+
+// Decode a single staged image in place. Already decoded images are left alone.
+bool DecodeImage( tinygltf::Image &image, int image_idx, std::string *err );
+
+// Decode all staged images of a model across the job pool
+bool DecodeImages( tinygltf::Model &model, std::string *err );
+
+#endif // _IMAGE_DECODE_HEADER_
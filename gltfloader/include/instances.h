@@ -0,0 +1,37 @@
+#ifndef _INSTANCES_HEADER_
+#define _INSTANCES_HEADER_
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#define INSTANCE_MATRIX_FLOATS      16
+#define INSTANCE_COLOR_FLOATS       4
+
+// Per instance data for drawing one mesh many times. The instance buffer has a
+// "mtx_world" (mat4, column major) and a "color" (vec4) stream. Instances are kept
+// packed: removing one moves the last instance into its slot, so the first count
+// elements are always the live ones. Instance ids stay valid until removed.
+int CreateInstanceSet( uint32_t capacity );
+bool DestroyInstanceSet( int set );
+bool IsInstanceSet( int set );
+void ClearInstanceSets();
+
+// matrix or color can be 0 (identity / white on add, unchanged on set)
+int AddInstance( int set, const float *matrix, const float *color );
+bool SetInstance( int set, int id, const float *matrix, const float *color );
+bool RemoveInstance( int set, int id );
+void ClearInstances( int set );
+uint32_t GetInstanceCount( int set );
+
+// Uploads pending changes and returns the buffer (owned by the set). The buffer
+// is recreated when the set outgrows it, so fetch it again after adding.
+dmBuffer::HBuffer GetInstanceBuffer( int set, uint32_t *count );
+
+// Called every update as callback(self, set, count) before the upload, to move
+// instances with instances_set. Pass 0 to remove (the old one is destroyed).
+bool SetInstanceCallback( int set, dmScript::LuaCallbackInfo *callback );
+
+// Runs the callbacks and uploads dirty sets, called from OnUpdategltfloader
+void UpdateInstanceSets();
+
+#endif // _INSTANCES_HEADER_
@@ -0,0 +1,24 @@
+#ifndef _JOBS_HEADER_
+#define _JOBS_HEADER_
+
+#include <stdint.h>
+
+// Small worker pool used by the loader for data parallel work (image decode etc).
+//   Workers are created on first use and live until ShutdownJobs is called.
+typedef void (*JobFunc)( void *ctx, uint32_t index );
+
+// Run func(ctx, i) for i in [0, count) across the pool. The calling thread
+// takes part in the work and the call returns once every index is done.
+// Safe to call from several threads and from inside a job, only one batch is
+// spread over the pool at a time and the others run on their caller.
+void ParallelFor( uint32_t count, JobFunc func, void *ctx );
+
+// Total threads that take part in a ParallelFor (workers + caller)
+uint32_t GetJobThreadCount();
+
+// Threads to use from the next ParallelFor on (0 = one per core). Not while a batch runs.
+void SetJobThreadCount( uint32_t threads );
+
+void ShutdownJobs();
+
+#endif // _JOBS_HEADER_
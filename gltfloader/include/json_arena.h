@@ -0,0 +1,41 @@
+#ifndef _JSON_ARENA_HEADER_
+#define _JSON_ARENA_HEADER_
+
+#include <stddef.h>
+
+// Bump allocator for the json DOM tinygltf builds while it parses a file.
+// tiny_gltf.h uses it for every object, array and string node of the bundled
+// nlohmann json unless TINYGLTF_NO_JSON_ARENA or TINYGLTF_USE_RAPIDJSON is
+// defined (RapidJSON brings its own pool allocator).
+//
+// The arena is per thread and only used between BeginJsonArena and EndJsonArena,
+// anything allocated outside of that goes to the heap as usual. A DOM built in
+// the arena must be gone before EndJsonArena, which drops the whole arena at once.
+
+void BeginJsonArena();
+void EndJsonArena();
+
+// Bytes handed out since BeginJsonArena
+size_t GetJsonArenaUsed();
+
+void *JsonArenaAlloc( size_t size );
+void JsonArenaFree( void *ptr, size_t size );
+
+template <typename T>
+struct JsonArenaAllocator
+{
+    typedef T value_type;
+
+    JsonArenaAllocator() {}
+    template <typename U> JsonArenaAllocator( const JsonArenaAllocator<U> & ) {}
+
+    T *allocate( size_t count )                 { return (T *)JsonArenaAlloc(count * sizeof(T)); }
+    void deallocate( T *ptr, size_t count )     { JsonArenaFree(ptr, count * sizeof(T)); }
+};
+
+template <typename T, typename U>
+bool operator==( const JsonArenaAllocator<T> &, const JsonArenaAllocator<U> & ) { return true; }
+template <typename T, typename U>
+bool operator!=( const JsonArenaAllocator<T> &, const JsonArenaAllocator<U> & ) { return false; }
+
+#endif // _JSON_ARENA_HEADER_
@@ -0,0 +1,26 @@
+#ifndef _LOD_MANAGER_HEADER_
+#define _LOD_MANAGER_HEADER_
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#define LOD_MAX_LEVELS      8
+
+// Picks a mesh buffer per tracked instance from the camera distance. Levels are
+// buffer resources (resource.create_buffer paths); switching sets the "vertices"
+// property of the instance's mesh component.
+//   Level i is used up to distances[i], hysteresis is a fraction of the distance
+//   in [0, 1). Distances must be positive and strictly increasing, anything else
+//   is rejected. A level whose property set fails is retried on the next update.
+bool AddLodInstance( dmhash_t id, dmhash_t component, const dmhash_t *levels, const float *distances, int numlevels, float hysteresis );
+bool RemoveLodInstance( dmhash_t id );
+void ClearLodInstances();
+
+// Camera is either a fixed position or a game object followed every frame
+void SetLodCameraPosition( const dmVMath::Point3 &position );
+void SetLodCameraInstance( dmhash_t id );
+
+// One pass over all tracked instances, called from OnUpdategltfloader
+void UpdateLods( dmGameObject::HCollection collection );
+
+#endif // _LOD_MANAGER_HEADER_
@@ -0,0 +1,66 @@
+#ifndef _MESH_HEADER_
+#define _MESH_HEADER_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tinygltf { class Model; struct Primitive; }
+
+// Maps a dmBuffer stream name (as used in temp001.buffer) to a glTF attribute
+typedef struct StreamAttribute {
+    const char      *stream;
+    const char      *attribute;
+} StreamAttribute;
+
+// Null terminated list: position -> POSITION, normal -> NORMAL, texcoord0 -> TEXCOORD_0 ...
+extern const StreamAttribute g_StreamAttributes[];
+
+// Triangle list indices for a primitive. Strips and fans are expanded, non indexed
+// primitives get 0..n-1. Returns false for points/lines or broken accessors.
+bool GetTriangleIndices( const tinygltf::Model &model, const tinygltf::Primitive &prim, std::vector<uint32_t> &out );
+
+// Vertex count of a primitive (the POSITION accessor count)
+size_t GetVertexCount( const tinygltf::Model &model, const tinygltf::Primitive &prim );
+
+// Attribute converted to packed floats. Returns the component count, 0 if the attribute is missing.
+int GetAttributeFloats( const tinygltf::Model &model, const tinygltf::Primitive &prim, const char *attribute, std::vector<float> &out );
+
+typedef struct GatherStream {
+    const float     *src;           // Packed source vertices
+    int             srccomponents;
+    float           *dst;           // First destination element
+    int             dstcomponents;
+    size_t          dststride;      // In floats
+} GatherStream;
+
+// out[i] = src[indices[i]] for every stream, in a single pass over the indices
+void GatherVertices( const uint32_t *indices, size_t count, const GatherStream *streams, int numstreams );
+
+typedef struct MeshStream {
+    std::string             name;           // dmBuffer stream name (position, normal ...)
+    int                     components;
+    std::vector<float>      data;           // vertexcount * components
+} MeshStream;
+
+// Indexed triangle list with packed float vertex streams. This is what the
+//   native mesh stages work on before it ends up in a dmBuffer.
+typedef struct MeshData {
+    std::vector<MeshStream> streams;
+    std::vector<uint32_t>   indices;
+    size_t                  vertexcount;
+    int                     material;
+    MeshData() : vertexcount(0), material(-1) {}
+} MeshData;
+
+// Vertices stay shared, the glTF indices are kept (strips/fans become lists)
+bool BuildMeshData( const tinygltf::Model &model, const tinygltf::Primitive &prim, MeshData &out );
+
+// Returns the stream or 0
+const MeshStream *FindMeshStream( const MeshData &mesh, const char *name );
+
+// Largest index + 1 must fit in 16 bits for a u16 index stream
+bool IndicesFitU16( const MeshData &mesh );
+
+#endif // _MESH_HEADER_
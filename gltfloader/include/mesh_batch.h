@@ -0,0 +1,35 @@
+#ifndef _MESH_BATCH_HEADER_
+#define _MESH_BATCH_HEADER_
+
+#include <vector>
+#include "mesh.h"
+
+namespace tinygltf { class Model; }
+
+// Where a source primitive ended up inside a batch (in batch indices)
+typedef struct BatchRange {
+    int             node;
+    int             mesh;
+    int             primitive;
+    size_t          firstindex;
+    size_t          indexcount;
+} BatchRange;
+
+// All primitives of a scene that share a material, node transforms baked in.
+//   Streams are the union of the source streams, missing ones are zero filled.
+typedef struct StaticBatch {
+    int                     material;
+    MeshData                mesh;
+    std::vector<BatchRange> ranges;
+} StaticBatch;
+
+// One batch per material used in the scene (scene < 0 is the default scene).
+//   Batches are ordered by material index, -1 (no material) first.
+void BuildStaticBatches( const tinygltf::Model &model, int scene, std::vector<StaticBatch> &out );
+
+// Positions by the full matrix, normals by the inverse transpose and tangents by the
+//   upper 3x3. A mirroring m (negative determinant) also reverses the triangle
+//   winding and the tangent w. m is column major 4x4.
+void TransformMeshData( MeshData &mesh, const float *m );
+
+#endif // _MESH_BATCH_HEADER_
@@ -0,0 +1,21 @@
+#ifndef _MESH_BUFFER_HEADER_
+#define _MESH_BUFFER_HEADER_
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#include "mesh.h"
+
+// One float32 stream per mesh stream, vertexcount elements
+bool CreateVertexBuffer( const MeshData &mesh, dmBuffer::HBuffer *out );
+
+// A single "indices" stream, uint16 when the vertex count allows it (uint32 otherwise)
+bool CreateIndexBuffer( const MeshData &mesh, dmBuffer::HBuffer *out );
+
+// Triangle soup (one vertex per index) for the mesh component, which draws without an index stream
+bool CreateUnindexedBuffer( const MeshData &mesh, dmBuffer::HBuffer *out );
+
+// Pushes the buffers onto the lua stack (owned by lua). Pushes nil for a failed buffer.
+void PushMeshBuffers( lua_State *L, const MeshData &mesh );
+
+#endif // _MESH_BUFFER_HEADER_
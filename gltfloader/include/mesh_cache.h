@@ -0,0 +1,236 @@
+#ifndef _MESH_CACHE_HEADER_
+#define _MESH_CACHE_HEADER_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "mesh.h"
+
+namespace tinygltf { class Model; }
+
+// Baked model cache. A flat little endian file, every table and data block is
+// 16 byte aligned so it can be used straight from a mapping:
+//
+//   BakeHeader
+//   BakePrimitive[]   indexed triangle lists, one float stream per attribute using
+//   BakeStream[]        the temp001.buffer names (position, normal, texcoord0 ...)
+//   BakeNode[]        local TRS, mesh, parent and children
+//   BakeMaterial[]    pbr factors and texture indices
+//   BakeTexture[] / BakeSampler[] / BakeImage[]  images keep their encoded png/jpg bytes
+//   BakeScene[] / BakeAnimation[] / BakeChannel[]  keyframes as floats
+//   BakeDependency[]  the source and every external file it references
+//   string table
+//   image data        encoded images, last so the part before it is buffer 0 on load
+//
+// A warm load has to give the same model as a cold one, so models using anything
+// the format has no table for (see CanBakeModel) are never baked.
+// Primitives with lod > 0 are simplified copies (gltfbake --lods). They come back
+// as extra meshes: lod k of mesh m is mesh m + k * nummeshes, with extras
+// { lod_of = m, lod = k }.
+#define BAKE_MAGIC          "GLTFBAKE"
+#define BAKE_VERSION        5
+#define BAKE_ALIGN          16
+#define BAKE_EXTENSION      ".bake"
+#define BAKE_CACHE_DIR      ".gltfcache"
+
+// Made by gltfbake, the runtime cache never overwrites it
+#define BAKE_FLAG_TOOL      1
+
+typedef struct BakeHeader {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    headersize;
+    uint64_t    filesize;
+    int32_t     defaultscene;
+    uint32_t    nummeshes;
+    uint32_t    numprimitives;
+    uint32_t    numnodes;
+    uint32_t    nummaterials;
+    uint32_t    numtextures;
+    uint32_t    numsamplers;
+    uint32_t    numimages;
+    uint32_t    numscenes;
+    uint32_t    numanimations;
+    uint32_t    numdependencies;
+    uint32_t    numlods;            // Highest lod level of any primitive
+    uint32_t    stringsize;
+    uint32_t    flags;              // BAKE_FLAG_*
+    uint64_t    primitives;         // Offsets from the start of the file
+    uint64_t    nodes;
+    uint64_t    materials;
+    uint64_t    textures;
+    uint64_t    samplers;
+    uint64_t    images;
+    uint64_t    scenes;
+    uint64_t    animations;
+    uint64_t    dependencies;
+    uint64_t    strings;
+    uint64_t    imagedata;          // Start of the image bytes, everything else is before it
+} BakeHeader;
+
+typedef struct BakeStream {
+    char        name[16];           // dmBuffer stream name
+    uint32_t    components;
+    uint32_t    pad;
+    uint64_t    data;               // vertexcount * components floats
+    float       min[4];
+    float       max[4];
+} BakeStream;
+
+typedef struct BakePrimitive {
+    uint32_t    meshname;           // String offset
+    int32_t     mesh;
+    int32_t     primitive;
+    int32_t     material;
+    uint32_t    vertexcount;
+    uint32_t    indexcount;
+    uint32_t    indexsize;          // 2 or 4
+    uint32_t    numstreams;
+    uint32_t    lod;
+    uint32_t    pad;
+    uint64_t    streams;            // BakeStream[numstreams]
+    uint64_t    indices;
+} BakePrimitive;
+
+typedef struct BakeNode {
+    uint32_t    name;
+    int32_t     mesh;
+    int32_t     parent;
+    uint32_t    numchildren;
+    uint64_t    children;           // int32_t[numchildren]
+    uint32_t    hasmatrix;          // The source used a matrix, restored as one
+    uint32_t    pad;
+    float       translation[3];
+    float       rotation[4];
+    float       scale[3];
+    float       matrix[16];
+} BakeNode;
+
+typedef struct BakeMaterial {
+    uint32_t    name;
+    int32_t     alphamode;          // 0 OPAQUE, 1 MASK, 2 BLEND
+    float       alphacutoff;
+    int32_t     doublesided;
+    float       basecolor[4];
+    float       emissive[3];
+    float       metallic;
+    float       roughness;
+    float       normalscale;
+    float       occlusionstrength;
+    int32_t     basecolortexture;   // Texture index, -1 for none
+    int32_t     metallicroughnesstexture;
+    int32_t     normaltexture;
+    int32_t     occlusiontexture;
+    int32_t     emissivetexture;
+    int32_t     texcoords[5];       // Same order as the textures above
+} BakeMaterial;
+
+typedef struct BakeTexture {
+    uint32_t    name;
+    int32_t     source;
+    int32_t     sampler;
+} BakeTexture;
+
+typedef struct BakeSampler {
+    uint32_t    name;
+    int32_t     minfilter;          // -1 when the source has none
+    int32_t     magfilter;
+    int32_t     wraps;
+    int32_t     wrapt;
+} BakeSampler;
+
+typedef struct BakeImage {
+    uint32_t    name;
+    uint32_t    mimetype;
+    uint32_t    uri;
+    uint32_t    pad;
+    uint64_t    data;               // Encoded file bytes
+    uint64_t    size;
+} BakeImage;
+
+typedef struct BakeScene {
+    uint32_t    name;
+    uint32_t    numnodes;
+    uint64_t    nodes;              // int32_t[numnodes]
+} BakeScene;
+
+typedef struct BakeAnimation {
+    uint32_t    name;
+    uint32_t    numchannels;
+    uint64_t    channels;           // BakeChannel[numchannels]
+} BakeAnimation;
+
+typedef struct BakeChannel {
+    int32_t     node;
+    uint32_t    path;               // String offset (translation, rotation ...)
+    uint32_t    interpolation;      // String offset (LINEAR, STEP, CUBICSPLINE)
+    uint32_t    numkeys;
+    uint32_t    numvalues;          // Elements, 3 * numkeys for CUBICSPLINE
+    uint32_t    components;
+    uint64_t    times;              // float[numkeys]
+    uint64_t    values;             // float[numvalues * components]
+} BakeChannel;
+
+// A file the bake was made from. Entry 0 is the source itself, the others are its
+// external buffers and images. The bake is current when every file still has its
+// size and content hash, the mtime only lets an untouched file skip the hash (a
+// copied or checked out bake stays valid).
+typedef struct BakeDependency {
+    uint32_t    uri;                // String offset, relative to the source directory
+    uint32_t    pad;
+    uint64_t    size;
+    uint64_t    mtime;
+    uint64_t    hash;               // FNV-1a of the contents
+} BakeDependency;
+
+// A primitive as it goes into the cache, after whatever processing the baker did
+typedef struct BakeMesh {
+    int         mesh;
+    int         primitive;
+    int         lod;
+    MeshData    data;
+} BakeMesh;
+
+// Every triangle primitive of the model as is (lod 0), what load_gltf bakes.
+// Returns false if a primitive could not be converted (it is left out).
+bool CollectBakeMeshes( const tinygltf::Model &model, std::vector<BakeMesh> &out );
+
+// False (with the reason) when the model uses something a bake can't store: skins,
+// cameras, morph targets, extensions or extras, non triangle list primitives or
+// attributes outside g_StreamAttributes. Such models are always parsed.
+bool CanBakeModel( const tinygltf::Model &model, std::string *reason );
+
+// gltfbake output for a glTF file (the source path + BAKE_EXTENSION)
+std::string GetMeshCachePath( const char *gltf_filename );
+// Where load_gltf caches a glTF file it parsed: the source path mirrored under
+// BAKE_CACHE_DIR, so development runs don't leave files in the model folders that
+// custom_resources would bundle
+std::string GetRuntimeCachePath( const char *gltf_filename );
+
+// Size and modification time of a file, stored in the cache to detect stale files
+bool GetSourceStamp( const char *path, uint64_t *size, uint64_t *mtime );
+
+// True if path is a bake of this version that gltfbake wrote (BAKE_FLAG_TOOL)
+bool IsToolBake( const char *path );
+
+// Images have to still be encoded (loaded with StageImageData), decoded pixels are not baked.
+//   The source and its external files are stamped, fails if CanBakeModel does.
+//   Written to a temporary file first so a failed write never leaves a broken cache.
+//   Missing parent directories are created.
+bool WriteMeshCache( const tinygltf::Model &model, const char *path, const char *source, std::string *err );
+// Same with the primitives given and BAKE_FLAG_* flags, the rest of the tables still come from the model
+bool WriteMeshCache( const tinygltf::Model &model, const std::vector<BakeMesh> &meshes, const char *path,
+                     const char *source, uint32_t flags, std::string *err );
+
+// Rebuilds a model from a bake: one buffer with all streams (the file up to the
+// image data), accessors with min/max, meshes, nodes, materials, textures, samplers,
+// encoded images (as_is), scenes and animations. A bake on disk is mapped, otherwise
+// it is read through the model file reader (ReadModelFile), as are the files it
+// depends on that are not on disk, so gltfbake output shipped next to its model in
+// custom_resources is used by bundles too. Returns false when the bake is missing,
+// not this version or when the contents of the source or any file it references
+// changed.
+bool ReadMeshCache( const char *path, const char *source, tinygltf::Model &model );
+
+#endif // _MESH_CACHE_HEADER_
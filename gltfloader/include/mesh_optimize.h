@@ -0,0 +1,29 @@
+#ifndef _MESH_OPTIMIZE_HEADER_
+#define _MESH_OPTIMIZE_HEADER_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mesh.h"
+
+// Post transform cache size the reordering targets (and ACMR is measured with)
+#define VERTEX_CACHE_SIZE      16
+
+typedef struct MeshOptimizeStats {
+    float       acmrbefore;     // Average cache miss ratio (misses per triangle, FIFO cache)
+    float       acmrafter;
+} MeshOptimizeStats;
+
+// Simulates a FIFO post transform cache over a triangle list
+float ComputeACMR( const uint32_t *indices, size_t count, size_t vertexcount, int cachesize );
+
+// Tipsify (Sander et al. 2007) triangle reorder for vertex cache locality, in place
+void OptimizeVertexCache( uint32_t *indices, size_t count, size_t vertexcount, int cachesize );
+
+// Reorders (and compacts) the vertices in first use order. Returns the new vertex count.
+size_t OptimizeVertexFetch( MeshData &mesh );
+
+// Both of the above. stats can be 0.
+void OptimizeMesh( MeshData &mesh, MeshOptimizeStats *stats );
+
+#endif // _MESH_OPTIMIZE_HEADER_
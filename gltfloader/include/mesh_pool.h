@@ -0,0 +1,47 @@
+#ifndef _MESH_POOL_HEADER_
+#define _MESH_POOL_HEADER_
+
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+#include <dmsdk/gamesys/components/comp_factory.h>
+
+// game.project
+//   [gltfloader]
+//   mesh_pool_capacity = 1024      slots reserved up front, the pool grows past it if needed
+//   mesh_pool_prewarm = 0          instances spawned at init and kept parked for reuse
+#define MESH_POOL_DEFAULT_CAPACITY      1024
+
+// Id of the mesh component in the mesh factory prototype (assets/gotemplate/meshpool/temp001.go)
+#define MESH_POOL_COMPONENT             "temp"
+
+// Mesh instances spawned from the mesh factory. Despawned instances are not
+// deleted, they are parked (disabled) on a free list and reused by the next spawn.
+// Instances deleted behind the pool's back (go.delete) are dropped from it, at the
+// latest when the collection hands their index out again. Ids are unique per
+// spawn ("/gltfmesh<index>_<generation>") so a stale one never names another object.
+void InitMeshPool( dmGameObject::HCollection collection, dmGameSystem::HFactoryWorld world,
+                   dmGameSystem::HFactoryComponent factory, dmConfigFile::HConfig config );
+void DestroyMeshPool();
+
+// Makes sure count parked instances are ready, returns how many are parked
+uint32_t PrewarmMeshPool( uint32_t count );
+
+// Returns 0 when no instance could be created (collection.max_instances)
+dmGameObject::HInstance SpawnPooledMesh( const dmVMath::Point3 &position, const dmVMath::Quat &rotation, const dmVMath::Vector3 &scale );
+bool DespawnPooledMesh( dmhash_t id );
+
+// Batch spawns acquire their collection instance indices in one go up front.
+//   Only count minus the parked instances are acquired, returns the number held.
+uint32_t AcquireMeshIndices( uint32_t count, std::vector<uint32_t> &indices );
+// Gives back the indices from first on (the ones a batch did not use)
+void ReleaseMeshIndices( const std::vector<uint32_t> &indices, size_t first );
+// Like SpawnPooledMesh but new instances take indices[*next] (and advance it)
+dmGameObject::HInstance SpawnPooledMeshReserved( const std::vector<uint32_t> &indices, size_t *next,
+                                                 const dmVMath::Point3 &position, const dmVMath::Quat &rotation, const dmVMath::Vector3 &scale );
+
+uint32_t GetMeshPoolActiveCount();
+uint32_t GetMeshPoolParkedCount();
+
+#endif // _MESH_POOL_HEADER_
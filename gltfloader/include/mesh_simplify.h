@@ -0,0 +1,16 @@
+#ifndef _MESH_SIMPLIFY_HEADER_
+#define _MESH_SIMPLIFY_HEADER_
+
+#include <stddef.h>
+
+#include "mesh.h"
+
+// Quadric error metric edge collapse (Garland & Heckbert). Vertices are welded by
+// position and a position moves onto a neighbouring one with all its split vertices
+// (UV/normal seams, flat shading), each remapped to a vertex of the target, so all
+// attributes stay valid. Seams cost extra by how much the remap changes the
+// attributes. Open borders are locked.
+//   ratio is the fraction of triangles to keep. Returns the triangle count of out.
+size_t SimplifyMesh( const MeshData &in, float ratio, MeshData &out );
+
+#endif // _MESH_SIMPLIFY_HEADER_
@@ -0,0 +1,28 @@
+#ifndef _MODEL_DESCRIBE_HEADER_
+#define _MODEL_DESCRIBE_HEADER_
+
+#include <stdio.h>
+
+namespace tinygltf { class Model; }
+
+// Receives the model summary as it is walked, depth first. key is 0 for the
+// elements of an array, the pointers are only valid during the call.
+typedef struct DescribeWriter {
+    void    *ctx;
+    void    (*begin)( void *ctx, const char *key, bool array );
+    void    (*end)( void *ctx, bool array );
+    void    (*number)( void *ctx, const char *key, double value );
+    void    (*string)( void *ctx, const char *key, const char *value );
+    void    (*boolean)( void *ctx, const char *key, bool value );
+} DescribeWriter;
+
+// One pass over the model: asset, scenes, nodes, meshes, accessors, buffer views,
+// buffers, materials, textures, images, samplers, animations, skins and cameras,
+// with their extras. Buffer data and pixels are left out, embedded buffers and
+// images only say so instead of passing on the data uri.
+void DescribeModel( const tinygltf::Model &model, const DescribeWriter *writer );
+
+// Same summary as compact json. Returns false if the write failed.
+bool WriteModelDescription( const tinygltf::Model &model, FILE *file );
+
+#endif // _MODEL_DESCRIBE_HEADER_
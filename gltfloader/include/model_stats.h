@@ -0,0 +1,31 @@
+#ifndef _MODEL_STATS_HEADER_
+#define _MODEL_STATS_HEADER_
+
+#include <stdint.h>
+
+namespace tinygltf { class Model; }
+
+// Heap bytes held by a loaded model, by what they are for. Measured from the
+// capacities of the containers (what the allocator handed out, not what the
+// file declared), so decoded and lazily decoded images are counted as they are now.
+typedef struct ModelMemory {
+    uint64_t    buffers;            // Buffer::data
+    uint64_t    images;             // Image::image, pixels or the encoded bytes of lazy loads
+    uint64_t    accessors;          // The accessor array with its min/max and sparse info
+    uint64_t    structures;         // Everything else from the json: nodes, meshes, materials, strings, extras ...
+    uint64_t    total;
+} ModelMemory;
+
+typedef struct ModelGeometry {
+    uint32_t    meshes;
+    uint32_t    primitives;
+    uint32_t    nodes;
+    uint64_t    vertices;           // POSITION counts of all primitives
+    uint64_t    triangles;          // Triangle lists, strips and fans, from the index count if indexed
+} ModelGeometry;
+
+void GetModelMemory( const tinygltf::Model &model, ModelMemory *out );
+
+void GetModelGeometry( const tinygltf::Model &model, ModelGeometry *out );
+
+#endif // _MODEL_STATS_HEADER_
@@ -0,0 +1,28 @@
+#ifndef _SCENE_HEADER_
+#define _SCENE_HEADER_
+
+#include <vector>
+
+namespace tinygltf { class Model; class Node; }
+
+// Matrices are 4x4 column major floats, same layout as glTF node.matrix
+
+// m = T * R * S (r is a quaternion x,y,z,w)
+void ComposeMatrix( const float *t, const float *r, const float *s, float *m );
+void MultiplyMatrix( const float *a, const float *b, float *out );
+// Inverse of ComposeMatrix for matrices without shear. A mirrored matrix gets a negative x scale.
+void DecomposeMatrix( const float *m, float *t, float *r, float *s );
+void GetNodeLocalMatrix( const tinygltf::Node &node, float *m );
+
+// Node TRS as floats (identity defaults). Nodes with a matrix are not decomposed.
+void GetNodeTRS( const tinygltf::Node &node, float *t, float *r, float *s );
+
+// Root nodes of a scene. scene < 0 picks the default scene, or every node without
+// a parent when the file has no scenes.
+void GetSceneRoots( const tinygltf::Model &model, int scene, std::vector<int> &roots );
+
+// World matrices for all nodes of a scene (16 floats per node, identity for nodes
+// outside the scene). order gets the nodes parent first, it can be 0.
+void ComputeWorldMatrices( const tinygltf::Model &model, int scene, std::vector<float> &matrices, std::vector<int> *order );
+
+#endif // _SCENE_HEADER_
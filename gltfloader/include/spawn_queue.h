@@ -0,0 +1,45 @@
+#ifndef _SPAWN_QUEUE_HEADER_
+#define _SPAWN_QUEUE_HEADER_
+
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+// game.project
+//   [gltfloader]
+//   spawn_budget_ms = 2.0          time per update spent on queued spawns
+#define SPAWN_DEFAULT_BUDGET_MS     2.0f
+
+typedef struct SpawnTransform {
+    float           position[3];
+    float           rotation[4];        // Quaternion x,y,z,w
+    float           scale[3];
+} SpawnTransform;
+
+void InitSpawnQueue( dmConfigFile::HConfig config );
+void ClearSpawnQueue();
+void SetSpawnBudget( float ms );
+
+// Queues a batch of pooled mesh spawns. Indices are reserved right away, the
+// instances are created over the next updates within the spawn budget. When
+// vertices is set it is assigned to the mesh component (MESH_POOL_COMPONENT) of every instance.
+// callback(self, job, ids) is called once all are spawned. Returns the job id.
+//   transforms is swapped out (left empty).
+int QueueSpawnBatch( std::vector<SpawnTransform> &transforms, dmhash_t vertices, dmScript::LuaCallbackInfo *callback );
+
+// Scene instantiation: one spawn per mesh node with the node's world transform and
+// vertices[i] as its mesh (0 leaves the prototype mesh). The callback gets progress
+// events every update: callback(self, job, { done, total, finished [, ids] }) with
+// ids = { [node + 1] = id } on the last one. nodes/vertices/transforms are swapped out.
+int QueueSpawnScene( std::vector<SpawnTransform> &transforms, std::vector<int> &nodes,
+                     std::vector<dmhash_t> &vertices, dmScript::LuaCallbackInfo *callback );
+
+bool CancelSpawnJob( int job );
+// false when the job is unknown (finished or cancelled)
+bool GetSpawnJobProgress( int job, uint32_t *done, uint32_t *total );
+
+// Spawns until the budget runs out, called from OnUpdategltfloader
+void UpdateSpawnQueue();
+
+#endif // _SPAWN_QUEUE_HEADER_
@@ -1720,9 +1720,15 @@ class TinyGLTF {
 #pragma GCC diagnostic ignored "-Wtype-limits"
 #endif  // __GNUC__
 
+// gltfloader: SIMD base64 for the data uris
+#include "base64.h"
+
 #ifndef TINYGLTF_NO_INCLUDE_JSON
 #ifndef TINYGLTF_USE_RAPIDJSON
 #include "json.hpp"
+#ifndef TINYGLTF_NO_JSON_ARENA
+#include "json_arena.h"
+#endif
 #else
 #ifndef TINYGLTF_NO_INCLUDE_RAPIDJSON
 #include "document.h"
@@ -1831,7 +1837,8 @@ using json = rapidjson::Value;
 using json_iterator = json::MemberIterator;
 using json_const_iterator = json::ConstMemberIterator;
 using json_const_array_iterator = json const *;
-rapidjson::Document *s_pActiveDocument = nullptr;
+// gltfloader: per thread, so files can be parsed in parallel (gltfbake -j).
+thread_local rapidjson::Document *s_pActiveDocument = nullptr;
 rapidjson::Document::AllocatorType &GetAllocator() {
   assert(s_pActiveDocument);  // Root json node must be JsonDocument type
   return s_pActiveDocument->GetAllocator();
@@ -1873,8 +1880,15 @@ struct JsonDocument : public rapidjson::Document {
 
 #endif  // TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
 
+#else
+#ifndef TINYGLTF_NO_JSON_ARENA
+// gltfloader: the DOM nodes come from the thread's json arena (json_arena.h)
+using json = nlohmann::basic_json<std::map, std::vector, std::string, bool,
+                                  std::int64_t, std::uint64_t, double,
+                                  JsonArenaAllocator>;
 #else
 using nlohmann::json;
+#endif
 using json_iterator = json::iterator;
 using json_const_iterator = json::const_iterator;
 using json_const_array_iterator = json_const_iterator;
@@ -3377,74 +3391,43 @@ bool IsDataURI(const std::string &in) {
 
 bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
                    const std::string &in, size_t reqBytes, bool checkSize) {
-  std::string header = "data:application/octet-stream;base64,";
-  std::string data;
-  if (in.find(header) == 0) {
-    data = base64_decode(in.substr(header.size()));  // cut mime string.
-  }
-
-  if (data.empty()) {
-    header = "data:image/jpeg;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/jpeg";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
-  }
-
-  if (data.empty()) {
-    header = "data:image/png;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/png";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
-  }
-
-  if (data.empty()) {
-    header = "data:image/bmp;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/bmp";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
-  }
-
-  if (data.empty()) {
-    header = "data:image/gif;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/gif";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
-    }
-  }
-
-  if (data.empty()) {
-    header = "data:text/plain;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "text/plain";
-      data = base64_decode(in.substr(header.size()));
-    }
-  }
-
-  if (data.empty()) {
-    header = "data:application/gltf-buffer;base64,";
-    if (in.find(header) == 0) {
-      data = base64_decode(in.substr(header.size()));
+  // gltfloader: the payload is decoded in place (base64.h) straight into out,
+  // instead of through a substr copy and a byte by byte std::string.
+  static const char *const headers[][2] = {
+      {"data:application/octet-stream;base64,", ""},
+      {"data:image/jpeg;base64,", "image/jpeg"},
+      {"data:image/png;base64,", "image/png"},
+      {"data:image/bmp;base64,", "image/bmp"},
+      {"data:image/gif;base64,", "image/gif"},
+      {"data:text/plain;base64,", "text/plain"},
+      {"data:application/gltf-buffer;base64,", ""}};
+
+  for (size_t h = 0; h < sizeof(headers) / sizeof(headers[0]); h++) {
+    size_t header_len = strlen(headers[h][0]);
+    if (in.compare(0, header_len, headers[h][0]) != 0) {
+      continue;
+    }
+    if (headers[h][1][0]) {
+      mime_type = headers[h][1];
+    }
+
+    const char *payload = in.data() + header_len;
+    size_t payload_len = in.size() - header_len;
+    out->resize(Base64DecodeBound(payload_len));
+    size_t decoded = Base64Decode(payload, payload_len, out->data());
+    out->resize(decoded);
+
+    // TODO(syoyo): Allow empty buffer? #229
+    if (decoded == 0) {
+      return false;
     }
-  }
-
-  // TODO(syoyo): Allow empty buffer? #229
-  if (data.empty()) {
-    return false;
-  }
-
-  if (checkSize) {
-    if (data.size() != reqBytes) {
+    if (checkSize && decoded != reqBytes) {
       return false;
     }
-    out->resize(reqBytes);
-  } else {
-    out->resize(data.size());
+    return true;
   }
-  std::copy(data.begin(), data.end(), out->begin());
-  return true;
+
+  return false;
 }
 
 namespace detail {
@@ -5984,6 +5967,20 @@ bool ForEachInArray(const detail::json &_v, const char *member, Callback &&cb) {
   return true;
 };
 
+// gltfloader: reserves room for the elements of a top level array up front, so
+// the objects are not moved again every time the vector grows.
+template <typename T>
+void ReserveForArray(const detail::json &_v, const char *member,
+                     std::vector<T> &out) {
+  detail::json_const_iterator itm;
+  if (detail::FindMember(_v, member, itm) &&
+      detail::IsArray(detail::GetValue(itm))) {
+    const detail::json &root = detail::GetValue(itm);
+    out.reserve(out.size() + size_t(std::distance(detail::ArrayBegin(root),
+                                                  detail::ArrayEnd(root))));
+  }
+}
+
 }  // end of namespace detail
 
 bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
@@ -6154,6 +6151,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 3. Parse Buffer
   {
+    detail::ReserveForArray(v, "buffers", model->buffers);
     bool success = ForEachInArray(v, "buffers", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6179,6 +6177,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
   // 4. Parse BufferView
   {
+    detail::ReserveForArray(v, "bufferViews", model->bufferViews);
     bool success = ForEachInArray(v, "bufferViews", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6203,6 +6202,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 5. Parse Accessor
   {
+    detail::ReserveForArray(v, "accessors", model->accessors);
     bool success = ForEachInArray(v, "accessors", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6227,6 +6227,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 6. Parse Mesh
   {
+    detail::ReserveForArray(v, "meshes", model->meshes);
     bool success = ForEachInArray(v, "meshes", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6314,6 +6315,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 7. Parse Node
   {
+    detail::ReserveForArray(v, "nodes", model->nodes);
     bool success = ForEachInArray(v, "nodes", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6338,6 +6340,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 8. Parse scenes.
   {
+    detail::ReserveForArray(v, "scenes", model->scenes);
     bool success = ForEachInArray(v, "scenes", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6373,6 +6376,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 10. Parse Material
   {
+    detail::ReserveForArray(v, "materials", model->materials);
     bool success = ForEachInArray(v, "materials", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6414,6 +6418,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   {
     int idx = 0;
+    detail::ReserveForArray(v, "images", model->images);
     bool success = ForEachInArray(v, "images", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6481,6 +6486,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 12. Parse Texture
   {
+    detail::ReserveForArray(v, "textures", model->textures);
     bool success = ForEachInArray(v, "textures", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6506,6 +6512,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 13. Parse Animation
   {
+    detail::ReserveForArray(v, "animations", model->animations);
     bool success = ForEachInArray(v, "animations", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6530,6 +6537,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 14. Parse Skin
   {
+    detail::ReserveForArray(v, "skins", model->skins);
     bool success = ForEachInArray(v, "skins", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6554,6 +6562,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 15. Parse Sampler
   {
+    detail::ReserveForArray(v, "samplers", model->samplers);
     bool success = ForEachInArray(v, "samplers", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -6578,6 +6587,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 16. Parse Camera
   {
+    detail::ReserveForArray(v, "cameras", model->cameras);
     bool success = ForEachInArray(v, "cameras", [&](const detail::json &o) {
       if (!detail::IsObject(o)) {
         if (err) {
@@ -0,0 +1,59 @@
+#ifndef _TINYGLTF_LOADER_HEADER_
+#define _TINYGLTF_LOADER_HEADER_
+
+#include <stdint.h>
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+// tinygltf_loader.cpp includes tiny_gltf.h with the implementation enabled, 
+//   so only pull it in here if nobody has done so already.
+#ifndef TINY_GLTF_H_
+#include "tiny_gltf.h"
+#endif
+
+#include "bounds.h"
+#include "animation.h"
+#include "gltf_parse.h"
+
+// Where the time of a load_gltf went, in microseconds
+typedef struct LoadTimings
+{
+    ParseStats                                  parse;      // parse.read is the file and buffer reads
+    uint64_t                                    images;     // DecodeImages, 0 for lazy loads
+    uint64_t                                    total;
+    bool                                        cached;     // Read from the .bake file
+
+} LoadTimings;
+
+typedef struct DefoldModel
+{
+    tinygltf::Model                             model;
+    std::vector< std::vector<PrimitiveBounds> > bounds;     // [mesh][primitive], model space
+    std::vector<AnimationClip>                  animations; // [animation], for sample_animation
+    std::vector<float>                          restpose;   // ANIMATION_TRS_FLOATS per node
+    LoadTimings                                 timings;
+
+} DefoldModel;
+
+// dump prints the model summary (model_describe.h) to stdout as json
+int load_gltf(const char *gltf_filename, bool dump, uint32_t flags);
+
+// Drops every loaded model, ids start from 0 again (tools/loadbench between runs)
+void ClearModels();
+
+// Ids are 0 .. GetModelCount() - 1
+int GetModelCount();
+
+// Returns 0 if the model id is not valid
+DefoldModel *GetDefoldModel(int modelid);
+tinygltf::Model *GetModel(int modelid);
+
+// Collection the extension spawns into (bootstrap.main_collection)
+dmGameObject::HCollection GetMainCollection();
+
+void InitMeshBuilding(dmResource::HFactory _Factory, dmConfigFile::HConfig _ConfigFile);
+void DestroyMeshBuilding();
+
+#endif // _TINYGLTF_LOADER_HEADER_
@@ -0,0 +1,410 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "accessor.h"
+#include "gltf_profile.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ACCESSOR_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ACCESSOR_NEON
+#endif
+
+// Conversions also run on the job threads
+static std::atomic<uint64_t>    g_convertedbytes(0);
+
+static void CountConverted( const AccessorView &view )
+{
+    g_convertedbytes.fetch_add((uint64_t)view.count * view.components * ComponentSize(view.componentType), std::memory_order_relaxed);
+}
+
+uint64_t TakeConvertedBytes()
+{
+    return g_convertedbytes.exchange(0);
+}
+
+int ComponentSize( int componentType )
+{
+    switch(componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:     return 1;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:    return 2;
+        case TINYGLTF_COMPONENT_TYPE_INT:
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:             return 4;
+        case TINYGLTF_COMPONENT_TYPE_DOUBLE:            return 8;
+    }
+    return 0;
+}
+
+bool GetAccessorView( const tinygltf::Model &model, int accessoridx, AccessorView *out )
+{
+    if( accessoridx < 0 || accessoridx >= (int)model.accessors.size() )
+        return false;
+    const tinygltf::Accessor &accessor = model.accessors[accessoridx];
+    if( accessor.sparse.isSparse || accessor.bufferView < 0 || accessor.bufferView >= (int)model.bufferViews.size() )
+        return false;
+
+    const tinygltf::BufferView &view = model.bufferViews[accessor.bufferView];
+    if( view.buffer < 0 || view.buffer >= (int)model.buffers.size() )
+        return false;
+    const tinygltf::Buffer &buffer = model.buffers[view.buffer];
+
+    int stride = accessor.ByteStride(view);
+    int components = tinygltf::GetNumComponentsInType(accessor.type);
+    if( stride <= 0 || components <= 0 || ComponentSize(accessor.componentType) == 0 )
+        return false;
+
+    out->data = buffer.data.empty() ? 0 : &buffer.data[0] + view.byteOffset + accessor.byteOffset;
+    out->count = accessor.count;
+    out->stride = stride;
+    out->componentType = accessor.componentType;
+    out->components = components;
+    out->normalized = accessor.normalized;
+
+    size_t offset = view.byteOffset + accessor.byteOffset;
+    if( offset + AccessorViewExtent(*out) > buffer.data.size() )
+        return false;
+    return true;
+}
+
+size_t AccessorViewExtent( const AccessorView &view )
+{
+    if( view.count == 0 ) return 0;
+    return (view.count - 1) * view.stride + view.components * ComponentSize(view.componentType);
+}
+
+// Scalar element read, used for the strided paths and the tails of the SIMD loops
+template<typename T>
+static inline T Load( const unsigned char *p )
+{
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+static inline float LoadFloat( const unsigned char *p, int componentType, bool normalized )
+{
+    switch(componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_BYTE: {
+            float v = (float)Load<int8_t>(p);
+            return normalized ? std::max(v / 127.0f, -1.0f) : v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+            float v = (float)Load<uint8_t>(p);
+            return normalized ? v / 255.0f : v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_SHORT: {
+            float v = (float)Load<int16_t>(p);
+            return normalized ? std::max(v / 32767.0f, -1.0f) : v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+            float v = (float)Load<uint16_t>(p);
+            return normalized ? v / 65535.0f : v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_INT:           return (float)Load<int32_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:  return (float)Load<uint32_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:         return Load<float>(p);
+        case TINYGLTF_COMPONENT_TYPE_DOUBLE:        return (float)Load<double>(p);
+    }
+    return 0.0f;
+}
+
+static inline uint32_t LoadU32( const unsigned char *p, int componentType )
+{
+    switch(componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_BYTE:              return (uint32_t)Load<int8_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:     return Load<uint8_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_SHORT:             return (uint32_t)Load<int16_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:    return Load<uint16_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_INT:               return (uint32_t)Load<int32_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:      return Load<uint32_t>(p);
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:             return (uint32_t)Load<float>(p);
+        case TINYGLTF_COMPONENT_TYPE_DOUBLE:            return (uint32_t)Load<double>(p);
+    }
+    return 0;
+}
+
+// Packed kernels: n values, src has no gaps. Each returns how many values it 
+//   handled so the caller can finish the tail with the scalar loads.
+
+static size_t ConvertPackedToFloat( const unsigned char *src, size_t n, int componentType, bool normalized, float *out )
+{
+    size_t i = 0;
+#if defined(ACCESSOR_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    switch(componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+            const __m128 scale = _mm_set1_ps(normalized ? 1.0f / 65535.0f : 1.0f);
+            for( ; i + 8 <= n; i += 8 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 2));
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+                _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+            }
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_SHORT: {
+            const __m128 scale = _mm_set1_ps(normalized ? 1.0f / 32767.0f : 1.0f);
+            const __m128 lowest = _mm_set1_ps(normalized ? -1.0f : -32768.0f);
+            for( ; i + 8 <= n; i += 8 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 2));
+                __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+                __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+                _mm_storeu_ps(out + i, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(lo), scale), lowest));
+                _mm_storeu_ps(out + i + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(hi), scale), lowest));
+            }
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+            const __m128 scale = _mm_set1_ps(normalized ? 1.0f / 255.0f : 1.0f);
+            for( ; i + 16 <= n; i += 16 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+                __m128i lo = _mm_unpacklo_epi8(v, zero);
+                __m128i hi = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+                _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+                _mm_storeu_ps(out + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+                _mm_storeu_ps(out + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+            }
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_BYTE: {
+            const __m128 scale = _mm_set1_ps(normalized ? 1.0f / 127.0f : 1.0f);
+            const __m128 lowest = _mm_set1_ps(normalized ? -1.0f : -128.0f);
+            for( ; i + 16 <= n; i += 16 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+                __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+                __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+                __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16);
+                __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16);
+                __m128i c = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16);
+                __m128i d = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16);
+                _mm_storeu_ps(out + i, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), scale), lowest));
+                _mm_storeu_ps(out + i + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), scale), lowest));
+                _mm_storeu_ps(out + i + 8, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), scale), lowest));
+                _mm_storeu_ps(out + i + 12, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(d), scale), lowest));
+            }
+            break;
+        }
+    }
+#elif defined(ACCESSOR_NEON)
+    switch(componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+            const float32x4_t scale = vdupq_n_f32(normalized ? 1.0f / 65535.0f : 1.0f);
+            for( ; i + 8 <= n; i += 8 )
+            {
+                uint16x8_t v = vld1q_u16((const uint16_t *)(src + i * 2));
+                vst1q_f32(out + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+                vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+            }
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_SHORT: {
+            const float32x4_t scale = vdupq_n_f32(normalized ? 1.0f / 32767.0f : 1.0f);
+            const float32x4_t lowest = vdupq_n_f32(normalized ? -1.0f : -32768.0f);
+            for( ; i + 8 <= n; i += 8 )
+            {
+                int16x8_t v = vld1q_s16((const int16_t *)(src + i * 2));
+                vst1q_f32(out + i, vmaxq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale), lowest));
+                vst1q_f32(out + i + 4, vmaxq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale), lowest));
+            }
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+            const float32x4_t scale = vdupq_n_f32(normalized ? 1.0f / 255.0f : 1.0f);
+            for( ; i + 8 <= n; i += 8 )
+            {
+                uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+                vst1q_f32(out + i, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+                vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+            }
+            break;
+        }
+        case TINYGLTF_COMPONENT_TYPE_BYTE: {
+            const float32x4_t scale = vdupq_n_f32(normalized ? 1.0f / 127.0f : 1.0f);
+            const float32x4_t lowest = vdupq_n_f32(normalized ? -1.0f : -128.0f);
+            for( ; i + 8 <= n; i += 8 )
+            {
+                int16x8_t v = vmovl_s8(vld1_s8((const int8_t *)(src + i)));
+                vst1q_f32(out + i, vmaxq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale), lowest));
+                vst1q_f32(out + i + 4, vmaxq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale), lowest));
+            }
+            break;
+        }
+    }
+#endif
+    return i;
+}
+
+static size_t ConvertPackedToU32( const unsigned char *src, size_t n, int componentType, uint32_t *out )
+{
+    size_t i = 0;
+#if defined(ACCESSOR_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    if( componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT )
+    {
+        for( ; i + 8 <= n; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 2));
+            _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi16(v, zero));
+            _mm_storeu_si128((__m128i *)(out + i + 4), _mm_unpackhi_epi16(v, zero));
+        }
+    }
+    else if( componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE )
+    {
+        for( ; i + 16 <= n; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *)(out + i + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *)(out + i + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i *)(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#elif defined(ACCESSOR_NEON)
+    if( componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT )
+    {
+        for( ; i + 8 <= n; i += 8 )
+        {
+            uint16x8_t v = vld1q_u16((const uint16_t *)(src + i * 2));
+            vst1q_u32(out + i, vmovl_u16(vget_low_u16(v)));
+            vst1q_u32(out + i + 4, vmovl_u16(vget_high_u16(v)));
+        }
+    }
+    else if( componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE )
+    {
+        for( ; i + 8 <= n; i += 8 )
+        {
+            uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+            vst1q_u32(out + i, vmovl_u16(vget_low_u16(v)));
+            vst1q_u32(out + i + 4, vmovl_u16(vget_high_u16(v)));
+        }
+    }
+#endif
+    return i;
+}
+
+void ConvertToFloat( const AccessorView &view, float *out )
+{
+    GLTF_PROFILE("GltfConvertAccessor");
+    CountConverted(view);
+    const int csize = ComponentSize(view.componentType);
+    const size_t esize = csize * view.components;
+
+    if( view.stride == esize )
+    {
+        const size_t n = view.count * view.components;
+        if( view.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT )
+        {
+            if( n ) memcpy(out, view.data, n * sizeof(float));
+            return;
+        }
+        size_t i = ConvertPackedToFloat(view.data, n, view.componentType, view.normalized, out);
+        for( ; i < n; ++i )
+            out[i] = LoadFloat(view.data + i * csize, view.componentType, view.normalized);
+        return;
+    }
+
+    // Interleaved data, walk element by element
+    const unsigned char *src = view.data;
+    for( size_t e=0; e<view.count; ++e, src += view.stride )
+    {
+        for( int c=0; c<view.components; ++c )
+            *out++ = LoadFloat(src + c * csize, view.componentType, view.normalized);
+    }
+}
+
+void ConvertToU32( const AccessorView &view, uint32_t *out )
+{
+    GLTF_PROFILE("GltfConvertAccessor");
+    CountConverted(view);
+    const int csize = ComponentSize(view.componentType);
+    const size_t esize = csize * view.components;
+
+    if( view.stride == esize )
+    {
+        const size_t n = view.count * view.components;
+        if( view.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT || view.componentType == TINYGLTF_COMPONENT_TYPE_INT )
+        {
+            if( n ) memcpy(out, view.data, n * sizeof(uint32_t));
+            return;
+        }
+        size_t i = ConvertPackedToU32(view.data, n, view.componentType, out);
+        for( ; i < n; ++i )
+            out[i] = LoadU32(view.data + i * csize, view.componentType);
+        return;
+    }
+
+    const unsigned char *src = view.data;
+    for( size_t e=0; e<view.count; ++e, src += view.stride )
+    {
+        for( int c=0; c<view.components; ++c )
+            *out++ = LoadU32(src + c * csize, view.componentType);
+    }
+}
+
+void ConvertToU16( const AccessorView &view, uint16_t *out )
+{
+    GLTF_PROFILE("GltfConvertAccessor");
+    CountConverted(view);
+    const int csize = ComponentSize(view.componentType);
+    const size_t esize = csize * view.components;
+
+    if( view.stride == esize )
+    {
+        const size_t n = view.count * view.components;
+        if( view.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT || view.componentType == TINYGLTF_COMPONENT_TYPE_SHORT )
+        {
+            if( n ) memcpy(out, view.data, n * sizeof(uint16_t));
+            return;
+        }
+        size_t i = 0;
+#if defined(ACCESSOR_SSE)
+        if( view.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE )
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for( ; i + 16 <= n; i += 16 )
+            {
+                __m128i v = _mm_loadu_si128((const __m128i *)(view.data + i));
+                _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128((__m128i *)(out + i + 8), _mm_unpackhi_epi8(v, zero));
+            }
+        }
+#elif defined(ACCESSOR_NEON)
+        if( view.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE )
+        {
+            for( ; i + 8 <= n; i += 8 )
+                vst1q_u16(out + i, vmovl_u8(vld1_u8(view.data + i)));
+        }
+#endif
+        // Anything wider is narrowed, the caller picks u16 only when the values fit
+        for( ; i < n; ++i )
+            out[i] = (uint16_t)LoadU32(view.data + i * csize, view.componentType);
+        return;
+    }
+
+    const unsigned char *src = view.data;
+    for( size_t e=0; e<view.count; ++e, src += view.stride )
+    {
+        for( int c=0; c<view.components; ++c )
+            *out++ = (uint16_t)LoadU32(src + c * csize, view.componentType);
+    }
+}
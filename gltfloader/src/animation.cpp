@@ -0,0 +1,228 @@
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "animation.h"
+#include "accessor.h"
+#include "scene.h"
+#include "gltf_profile.h"
+
+static bool GetTrackPath( const std::string &path, int *out, int *components )
+{
+    if( path == "translation" )     { *out = ANIMATION_TRANSLATION; *components = 3; return true; }
+    if( path == "rotation" )        { *out = ANIMATION_ROTATION; *components = 4; return true; }
+    if( path == "scale" )           { *out = ANIMATION_SCALE; *components = 3; return true; }
+    return false;
+}
+
+static int GetInterpolation( const std::string &interpolation )
+{
+    if( interpolation == "STEP" ) return ANIMATION_STEP;
+    if( interpolation == "CUBICSPLINE" ) return ANIMATION_CUBICSPLINE;
+    return ANIMATION_LINEAR;
+}
+
+static bool BuildTrack( const tinygltf::Model &model, const tinygltf::Animation &anim, const tinygltf::AnimationChannel &channel, AnimationTrack *track )
+{
+    if( channel.target_node < 0 || channel.target_node >= (int)model.nodes.size() ) return false;
+    if( channel.sampler < 0 || channel.sampler >= (int)anim.samplers.size() ) return false;
+    if( !GetTrackPath(channel.target_path, &track->path, &track->components) ) return false;
+
+    const tinygltf::AnimationSampler &sampler = anim.samplers[channel.sampler];
+    track->node = channel.target_node;
+    track->interpolation = GetInterpolation(sampler.interpolation);
+
+    AccessorView input, output;
+    if( !GetAccessorView(model, sampler.input, &input) || input.count == 0 || input.components != 1 ) return false;
+    if( !GetAccessorView(model, sampler.output, &output) || output.components != track->components ) return false;
+    size_t keysize = track->interpolation == ANIMATION_CUBICSPLINE ? 3 : 1;
+    if( output.count != input.count * keysize ) return false;
+
+    track->times.resize(input.count);
+    ConvertToFloat(input, track->times.data());
+    track->values.resize(output.count * output.components);
+    ConvertToFloat(output, track->values.data());
+
+    // Cubic splines need two keys to have tangents to interpolate, a single key
+    // keeps only its value (the middle of in-tangent, value, out-tangent)
+    if( track->interpolation == ANIMATION_CUBICSPLINE && input.count < 2 )
+    {
+        int n = track->components;
+        track->values.erase(track->values.begin(), track->values.begin() + n);
+        track->values.resize(n);
+        track->interpolation = ANIMATION_LINEAR;
+    }
+    return true;
+}
+
+void BuildAnimationClips( const tinygltf::Model &model, std::vector<AnimationClip> &clips )
+{
+    GLTF_PROFILE("GltfBuildAnimations");
+    clips.clear();
+    clips.resize(model.animations.size());
+    for( size_t a=0; a<model.animations.size(); ++a )
+    {
+        const tinygltf::Animation &anim = model.animations[a];
+        AnimationClip &clip = clips[a];
+        clip.duration = 0.0f;
+        clip.tracks.reserve(anim.channels.size());
+        for( size_t c=0; c<anim.channels.size(); ++c )
+        {
+            AnimationTrack track;
+            if( !BuildTrack(model, anim, anim.channels[c], &track) ) continue;
+            clip.duration = std::max(clip.duration, track.times.back());
+            clip.tracks.push_back(std::move(track));
+        }
+    }
+}
+
+void GetRestPose( const tinygltf::Model &model, std::vector<float> &pose )
+{
+    pose.resize(model.nodes.size() * ANIMATION_TRS_FLOATS);
+    for( size_t n=0; n<model.nodes.size(); ++n )
+    {
+        const tinygltf::Node &node = model.nodes[n];
+        float *trs = &pose[n * ANIMATION_TRS_FLOATS];
+        float *t = trs + ANIMATION_TRANSLATION, *r = trs + ANIMATION_ROTATION, *s = trs + ANIMATION_SCALE;
+        if( node.matrix.size() == 16 )
+        {
+            float m[16];
+            GetNodeLocalMatrix(node, m);
+            DecomposeMatrix(m, t, r, s);
+        }
+        else
+            GetNodeTRS(node, t, r, s);
+    }
+}
+
+// Key i with times[i] <= time < times[i + 1], time is inside the track. The
+// cursor is only a hint, any value is safe (a stale one from another clip too).
+static size_t FindKey( const AnimationTrack &track, float time, size_t *cursor )
+{
+    const float *times = track.times.data();
+    size_t count = track.times.size();
+
+    // Monotonic time stays on the same key or moves to the next one
+    if( cursor )
+    {
+        size_t i = *cursor;
+        if( i + 1 < count && times[i] <= time )
+        {
+            if( time < times[i + 1] ) return i;
+            if( i + 2 < count && time < times[i + 2] )
+            {
+                *cursor = i + 1;
+                return i + 1;
+            }
+        }
+    }
+
+    size_t i = std::upper_bound(times, times + count, time) - times;
+    i = i > 0 ? i - 1 : 0;
+    if( i > count - 2 ) i = count - 2;
+    if( cursor ) *cursor = i;
+    return i;
+}
+
+static void Normalize( float *q )
+{
+    float len = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if( len <= 0.0f ) return;
+    float inv = 1.0f / len;
+    for( int c=0; c<4; ++c ) q[c] *= inv;
+}
+
+// Shortest path, close quaternions fall back to a normalized lerp
+static void Slerp( const float *a, const float *b, float u, float *out )
+{
+    float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    float sign = 1.0f;
+    if( dot < 0.0f )
+    {
+        dot = -dot;
+        sign = -1.0f;
+    }
+
+    float wa, wb;
+    if( dot > 0.9995f )
+    {
+        wa = 1.0f - u;
+        wb = u;
+    }
+    else
+    {
+        float theta = acosf(dot);
+        float inv = 1.0f / sinf(theta);
+        wa = sinf((1.0f - u) * theta) * inv;
+        wb = sinf(u * theta) * inv;
+    }
+    for( int c=0; c<4; ++c )
+        out[c] = wa * a[c] + sign * wb * b[c];
+    Normalize(out);
+}
+
+void SampleTrack( const AnimationTrack &track, float time, float *out, size_t *cursor )
+{
+    int n = track.components;
+    size_t count = track.times.size();
+    bool cubic = track.interpolation == ANIMATION_CUBICSPLINE;
+    size_t keysize = cubic ? 3 * n : n;
+    size_t value = cubic ? n : 0;       // The value between the tangents
+    const float *values = track.values.data();
+
+    if( count == 1 || time <= track.times[0] )
+    {
+        memcpy(out, values + value, n * sizeof(float));
+        return;
+    }
+    if( time >= track.times[count - 1] )
+    {
+        memcpy(out, values + (count - 1) * keysize + value, n * sizeof(float));
+        return;
+    }
+
+    size_t i = FindKey(track, time, cursor);
+    float t0 = track.times[i], dt = track.times[i + 1] - t0;
+    float u = (time - t0) / dt;
+    const float *k0 = values + i * keysize;
+    const float *k1 = k0 + keysize;
+
+    if( track.interpolation == ANIMATION_STEP )
+    {
+        memcpy(out, k0, n * sizeof(float));
+    }
+    else if( cubic )
+    {
+        // Hermite spline, tangents are scaled by the key interval
+        float u2 = u * u, u3 = u2 * u;
+        float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+        float h10 = (u3 - 2.0f * u2 + u) * dt;
+        float h01 = -2.0f * u3 + 3.0f * u2;
+        float h11 = (u3 - u2) * dt;
+        for( int c=0; c<n; ++c )
+            out[c] = h00 * k0[n + c] + h10 * k0[2 * n + c] + h01 * k1[n + c] + h11 * k1[c];
+        if( track.path == ANIMATION_ROTATION ) Normalize(out);
+    }
+    else if( track.path == ANIMATION_ROTATION )
+    {
+        Slerp(k0, k1, u, out);
+    }
+    else
+    {
+        for( int c=0; c<n; ++c )
+            out[c] = k0[c] + (k1[c] - k0[c]) * u;
+    }
+}
+
+void SampleAnimation( const AnimationClip &clip, float time, float *pose, size_t nodes, size_t *cursors )
+{
+    GLTF_PROFILE("GltfSampleAnimation");
+    for( size_t i=0; i<clip.tracks.size(); ++i )
+    {
+        const AnimationTrack &track = clip.tracks[i];
+        if( (size_t)track.node >= nodes ) continue;
+        SampleTrack(track, time, pose + track.node * ANIMATION_TRS_FLOATS + track.path, cursors ? cursors + i : 0);
+    }
+}
@@ -0,0 +1,149 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base64.h"
+#include "gltf_profile.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BASE64_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BASE64_NEON
+#endif
+
+size_t Base64DecodeBound( size_t len )
+{
+    return len / 4 * 3 + 3;
+}
+
+static inline int DecodeChar( unsigned char c )
+{
+    if( c >= 'A' && c <= 'Z' ) return c - 'A';
+    if( c >= 'a' && c <= 'z' ) return c - 'a' + 26;
+    if( c >= '0' && c <= '9' ) return c - '0' + 52;
+    if( c == '+' ) return 62;
+    if( c == '/' ) return 63;
+    return -1;
+}
+
+#if defined(BASE64_SSE)
+
+// 16 characters -> 12 bytes, 14 bytes are written. Returns false (and writes
+// nothing) if the block has anything outside the alphabet, '=' included.
+static inline bool DecodeBlock( const char *in, unsigned char *out )
+{
+    __m128i c = _mm_loadu_si128((const __m128i *)in);
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+    __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+    if( _mm_movemask_epi8(valid) != 0xFFFF ) return false;
+
+    // Character to its 6 bit value by adding the offset of its range
+    __m128i shift = _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    shift = _mm_or_si128(shift, _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(62 - '+')), _mm_and_si128(slash, _mm_set1_epi8(63 - '/'))));
+    __m128i v = _mm_add_epi8(c, shift);
+
+    // a b c d in every 32 bits: 12 bits per 16 bit lane, then 24 bits per 32 bit lane
+    __m128i ab = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00FF)), 6), _mm_srli_epi16(v, 8));
+    __m128i x = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(ab, _mm_set1_epi32(0x0000FFFF)), 12), _mm_srli_epi32(ab, 16));
+
+    // Most significant byte first, then drop the empty fourth byte of each lane
+    __m128i swapped = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(0xFF)), 16), _mm_and_si128(x, _mm_set1_epi32(0xFF00)));
+    swapped = _mm_or_si128(swapped, _mm_srli_epi32(x, 16));
+    __m128i packed = _mm_or_si128(_mm_and_si128(swapped, _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF)),
+                                  _mm_srli_epi64(_mm_and_si128(swapped, _mm_set_epi32(0x00FFFFFF, 0, 0x00FFFFFF, 0)), 8));
+    _mm_storel_epi64((__m128i *)out, packed);
+    _mm_storel_epi64((__m128i *)(out + 6), _mm_unpackhi_epi64(packed, packed));
+    return true;
+}
+
+#define BASE64_BLOCK_IN     16
+#define BASE64_BLOCK_OUT    12
+
+#elif defined(BASE64_NEON)
+
+static inline uint8x16_t Translate( uint8x16_t c, uint8x16_t *valid )
+{
+    uint8x16_t upper = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+    uint8x16_t lower = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+    uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')), vcleq_u8(c, vdupq_n_u8('9')));
+    uint8x16_t plus = vceqq_u8(c, vdupq_n_u8('+'));
+    uint8x16_t slash = vceqq_u8(c, vdupq_n_u8('/'));
+    *valid = vandq_u8(*valid, vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash));
+
+    uint8x16_t shift = vorrq_u8(vandq_u8(upper, vdupq_n_u8((uint8_t)-'A')), vandq_u8(lower, vdupq_n_u8((uint8_t)(26 - 'a'))));
+    shift = vorrq_u8(shift, vandq_u8(digit, vdupq_n_u8((uint8_t)(52 - '0'))));
+    shift = vorrq_u8(shift, vorrq_u8(vandq_u8(plus, vdupq_n_u8(62 - '+')), vandq_u8(slash, vdupq_n_u8(63 - '/'))));
+    return vaddq_u8(c, shift);
+}
+
+// 64 characters -> 48 bytes, the load splits them into the a, b, c, d of each quad
+static inline bool DecodeBlock( const char *in, unsigned char *out )
+{
+    uint8x16x4_t c = vld4q_u8((const uint8_t *)in);
+    uint8x16_t valid = vdupq_n_u8(0xFF);
+    uint8x16_t a = Translate(c.val[0], &valid);
+    uint8x16_t b = Translate(c.val[1], &valid);
+    uint8x16_t d2 = Translate(c.val[2], &valid);
+    uint8x16_t d3 = Translate(c.val[3], &valid);
+    uint64x2_t all = vreinterpretq_u64_u8(valid);
+    if( (vgetq_lane_u64(all, 0) & vgetq_lane_u64(all, 1)) != ~(uint64_t)0 ) return false;
+
+    uint8x16x3_t bytes;
+    bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d2, 2));
+    bytes.val[2] = vorrq_u8(vshlq_n_u8(d2, 6), d3);
+    vst3q_u8(out, bytes);
+    return true;
+}
+
+#define BASE64_BLOCK_IN     64
+#define BASE64_BLOCK_OUT    48
+
+#endif
+
+size_t Base64Decode( const char *in, size_t len, unsigned char *out )
+{
+    GLTF_PROFILE("GltfBase64Decode");
+    size_t i = 0, o = 0;
+
+#if defined(BASE64_BLOCK_IN)
+    // Stops at the block with the padding (or anything else), the rest goes scalar
+    while( i + BASE64_BLOCK_IN <= len && DecodeBlock(in + i, out + o) )
+    {
+        i += BASE64_BLOCK_IN;
+        o += BASE64_BLOCK_OUT;
+    }
+#endif
+
+    uint32_t acc = 0;
+    int count = 0;
+    for( ; i < len; ++i )
+    {
+        int v = DecodeChar((unsigned char)in[i]);
+        if( v < 0 ) break;
+        acc = (acc << 6) | (uint32_t)v;
+        if( ++count == 4 )
+        {
+            out[o++] = (unsigned char)(acc >> 16);
+            out[o++] = (unsigned char)(acc >> 8);
+            out[o++] = (unsigned char)acc;
+            acc = 0;
+            count = 0;
+        }
+    }
+
+    // A partial quad of n characters holds n - 1 bytes
+    if( count > 1 )
+    {
+        acc <<= 6 * (4 - count);
+        out[o++] = (unsigned char)(acc >> 16);
+        if( count > 2 ) out[o++] = (unsigned char)(acc >> 8);
+    }
+    return o;
+}
@@ -0,0 +1,143 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "bounds.h"
+#include "accessor.h"
+#include "gltf_profile.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BOUNDS_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BOUNDS_NEON
+#endif
+
+void ReducePositionBounds( const unsigned char *data, size_t count, size_t stride, float *outmin, float *outmax )
+{
+    float mn[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+    float mx[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    size_t i = 0;
+
+    // Each vertex is loaded as 4 floats (xyz + whatever follows), so the last 
+    // vertex is always done scalar to not read past the end of the buffer.
+    size_t simdcount = (count > 0) ? count - 1 : 0;
+
+#if defined(BOUNDS_SSE)
+    __m128 vmin0 = _mm_loadu_ps(mn), vmin1 = vmin0;
+    __m128 vmax0 = _mm_loadu_ps(mx), vmax1 = vmax0;
+    for( ; i + 1 < simdcount; i += 2 )
+    {
+        __m128 a = _mm_loadu_ps((const float *)(data + i * stride));
+        __m128 b = _mm_loadu_ps((const float *)(data + (i + 1) * stride));
+        vmin0 = _mm_min_ps(vmin0, a);
+        vmax0 = _mm_max_ps(vmax0, a);
+        vmin1 = _mm_min_ps(vmin1, b);
+        vmax1 = _mm_max_ps(vmax1, b);
+    }
+    _mm_storeu_ps(mn, _mm_min_ps(vmin0, vmin1));
+    _mm_storeu_ps(mx, _mm_max_ps(vmax0, vmax1));
+#elif defined(BOUNDS_NEON)
+    float32x4_t vmin0 = vld1q_f32(mn), vmin1 = vmin0;
+    float32x4_t vmax0 = vld1q_f32(mx), vmax1 = vmax0;
+    for( ; i + 1 < simdcount; i += 2 )
+    {
+        float32x4_t a = vld1q_f32((const float *)(data + i * stride));
+        float32x4_t b = vld1q_f32((const float *)(data + (i + 1) * stride));
+        vmin0 = vminq_f32(vmin0, a);
+        vmax0 = vmaxq_f32(vmax0, a);
+        vmin1 = vminq_f32(vmin1, b);
+        vmax1 = vmaxq_f32(vmax1, b);
+    }
+    vst1q_f32(mn, vminq_f32(vmin0, vmin1));
+    vst1q_f32(mx, vmaxq_f32(vmax0, vmax1));
+#endif
+
+    for( ; i < count; ++i )
+    {
+        float p[3];
+        memcpy(p, data + i * stride, sizeof(p));
+        for( int c=0; c<3; ++c )
+        {
+            mn[c] = std::min(mn[c], p[c]);
+            mx[c] = std::max(mx[c], p[c]);
+        }
+    }
+
+    memcpy(outmin, mn, sizeof(float) * 3);
+    memcpy(outmax, mx, sizeof(float) * 3);
+}
+
+bool ComputePrimitiveBounds( const tinygltf::Model &model, const tinygltf::Primitive &prim, PrimitiveBounds *out )
+{
+    out->valid = false;
+    std::map<std::string, int>::const_iterator it = prim.attributes.find("POSITION");
+    if( it == prim.attributes.end() || it->second < 0 || it->second >= (int)model.accessors.size() )
+        return false;
+
+    const tinygltf::Accessor &accessor = model.accessors[it->second];
+
+    // The spec requires min/max on POSITION, so this is the common path.
+    //   Normalized (quantized) min/max are in raw units, those get reduced below.
+    if( !accessor.normalized && accessor.minValues.size() >= 3 && accessor.maxValues.size() >= 3 )
+    {
+        for( int c=0; c<3; ++c )
+        {
+            out->min[c] = (float)accessor.minValues[c];
+            out->max[c] = (float)accessor.maxValues[c];
+        }
+        out->valid = true;
+        return true;
+    }
+
+    AccessorView view;
+    if( !GetAccessorView(model, it->second, &view) || view.count == 0 || view.components != 3 )
+        return false;
+
+    if( view.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT )
+    {
+        ReducePositionBounds(view.data, view.count, view.stride, out->min, out->max);
+    }
+    else
+    {
+        // Quantized positions, convert first (the reduce then runs on packed floats)
+        std::vector<float> positions(view.count * 3);
+        ConvertToFloat(view, &positions[0]);
+        ReducePositionBounds((const unsigned char *)&positions[0], view.count, sizeof(float) * 3, out->min, out->max);
+    }
+    out->valid = true;
+    return true;
+}
+
+void ComputeModelBounds( const tinygltf::Model &model, std::vector< std::vector<PrimitiveBounds> > &bounds )
+{
+    GLTF_PROFILE("GltfComputeBounds");
+    bounds.resize(model.meshes.size());
+    for( size_t m=0; m<model.meshes.size(); ++m )
+    {
+        const tinygltf::Mesh &mesh = model.meshes[m];
+        bounds[m].resize(mesh.primitives.size());
+        for( size_t p=0; p<mesh.primitives.size(); ++p )
+            ComputePrimitiveBounds(model, mesh.primitives[p], &bounds[m][p]);
+    }
+}
+
+bool MergeBounds( const std::vector<PrimitiveBounds> &bounds, PrimitiveBounds *out )
+{
+    out->valid = false;
+    for( size_t i=0; i<bounds.size(); ++i )
+    {
+        if( !bounds[i].valid ) continue;
+        for( int c=0; c<3; ++c )
+        {
+            out->min[c] = out->valid ? std::min(out->min[c], bounds[i].min[c]) : bounds[i].min[c];
+            out->max[c] = out->valid ? std::max(out->max[c], bounds[i].max[c]) : bounds[i].max[c];
+        }
+        out->valid = true;
+    }
+    return out->valid;
+}
@@ -7,6 +7,7 @@
 #include <dmsdk/sdk.h>
 
 #include "geom.h"
+#include "gltf_profile.h"
 
 // List of all the objects bounding boxes (will put this in a lqdb for fast raycasting)
 //   Initially use AABB (much faster) use OBox later + lqdb
@@ -179,10 +180,39 @@ bool intersectOBB( Ray ray, OBB obb, float *distance)
 	return true;
 }
 
-static int AddBoundingBox(lua_State *L)
+int AddBounds( Vec3 vmin, Vec3 vmax, uint64_t tag )
 {
     OBB obb;
-    
+
+    // obb.axis[0]     = Vec3(1,0,0);
+    // obb.axis[1]     = Vec3(0,1,0);
+    // obb.axis[2]     = Vec3(0,0,1);
+
+    obb.axis[0]     = vmin;
+    obb.axis[1]     = vmax;
+
+    obb.center = Vec3((vmax.x - vmin.x) * 0.5 + vmin.x, (vmax.y - vmin.y) * 0.5 + vmin.y, (vmax.z - vmin.z) * 0.5 + vmin.z);
+    obb.extents = Vec3((vmax.x - vmin.x) * 0.5, (vmax.y - vmin.y) * 0.5, (vmax.z - vmin.z) * 0.5);
+    obb.tag = tag;
+    // Until updateobb is called the box sits at the origin
+    obb.mat = dmVMath::Matrix4::identity();
+    g_bounds.push_back(obb);
+    return g_bounds.size() - 1;
+}
+
+void ClearBounds()
+{
+    g_bounds.clear();
+}
+
+void SetBoundsWorld( int index, const dmVMath::Matrix4 &world )
+{
+    g_bounds[index].mat = world;
+}
+
+int AddBoundingBox(lua_State *L)
+{
+    DM_PROFILE("gltfloader.addboundingbox");
     DM_LUA_STACK_CHECK(L, 1);
     // Min
     dmVMath::Vector3    vmin = *dmScript::CheckVector3(L, 1);
@@ -192,24 +222,8 @@ static int AddBoundingBox(lua_State *L)
     // Tag used when doing hits
     uint64_t tag = dmScript::CheckHash(L, 3);
 
-    dmVMath::Vector3 center = (vmax - vmin) * 0.5 + vmin;
-    dmVMath::Vector3 extents;
-    extents[0] = (vmax[0] - vmin[0]) * 0.5;
-    extents[1] = (vmax[1] - vmin[1]) * 0.5;
-    extents[2] = (vmax[2] - vmin[2]) * 0.5;
-
-    // obb.axis[0]     = Vec3(1,0,0);
-    // obb.axis[1]     = Vec3(0,1,0);
-    // obb.axis[2]     = Vec3(0,0,1);
-
-    obb.axis[0]     = Vec3(vmin[0],vmin[1],vmin[2]);
-    obb.axis[1]     = Vec3(vmax[0],vmax[1],vmax[2]);
-
-    obb.center = Vec3(center[0], center[1], center[2]);
-    obb.extents = Vec3(extents[0], extents[1], extents[2]);
-    obb.tag = tag;
-    g_bounds.push_back(obb);
-    lua_pushnumber(L, g_bounds.size() - 1);
+    int index = AddBounds(Vec3(vmin[0],vmin[1],vmin[2]), Vec3(vmax[0],vmax[1],vmax[2]), tag);
+    lua_pushnumber(L, index);
     return 1;
 } 
 
@@ -231,8 +245,32 @@ OBB MultWorld( OBB obb )
     return out;
 }
 
-static int RaycastToBox( lua_State *L)
+int RaycastBounds( const Ray &ray, float *closest )
+{
+    DM_PROFILE("GltfRaycast");
+    DM_PROPERTY_ADD_U32(rmtp_GltfRaysTested, 1);
+    DM_PROPERTY_ADD_U32(rmtp_GltfBoxesVisited, (uint32_t)g_bounds.size());
+
+    // Go through boxes checking hits. Closest hit wins!
+    float distance = FLT_MAX;
+    int hitbox = -1;
+    *closest = FLT_MAX;
+    for(int i=0; i<g_bounds.size(); ++i)
+    {
+        OBB testbox = MultWorld(g_bounds[i]);
+        if( intersectOBB(ray, testbox, &distance ) ) {
+            if(distance < *closest) {
+                *closest = distance;
+                hitbox = i;
+            }
+        }
+    }
+    return hitbox;
+}
+
+int RaycastToBox( lua_State *L)
 {
+    DM_PROFILE("gltfloader.raycasttobox");
     DM_LUA_STACK_CHECK(L, 3);
     // Origin
     float x1 = luaL_checknumber(L, 1);
@@ -245,23 +283,11 @@ static int RaycastToBox( lua_State *L)
 
     struct Ray ray(Vec3(x1, y1, z1), Vec3(x2, y2, z2));
 
-    // Go through boxes checking hits. Closest hit wins!
-    float distance = FLT_MAX;
-    float closest = FLT_MAX;
-    int hitbox = -1;
+    float closest;
     float hitpoint[3];
-    for(int i=0; i<g_bounds.size(); ++i)
-    {
-        OBB testbox = MultWorld(g_bounds[i]);
-        if( intersectOBB(ray, testbox, &distance ) ) {
-            if(distance < closest) {
-                closest = distance;
-                hitbox = i;
-            }
-        }
-    }
-    
-    if(closest == FLT_MAX) 
+    int hitbox = RaycastBounds(ray, &closest);
+
+    if(hitbox < 0)
     {
         lua_pushnil(L);
         lua_pushnil(L);
@@ -279,14 +305,15 @@ static int RaycastToBox( lua_State *L)
     return 3;
 }
 
-static int UpdateOBB( lua_State *L )
+int UpdateOBB( lua_State *L )
 {
+    DM_PROFILE("gltfloader.updateobb");
     DM_LUA_STACK_CHECK(L, 0);
     int     index = luaL_checknumber(L, 1);
     dmVMath::Matrix4 world    = *dmScript::CheckMatrix4(L, 2);
 
     // Need to do some index checking here.
-    g_bounds[index].mat = world;
+    SetBoundsWorld(index, world);
     return 0;
 }
 
@@ -359,8 +386,9 @@ float perlin2d(float x, float y, float freq, int depth)
     return fin/div;
 }
 
-static int PerlinNoise( lua_State *L )
+int PerlinNoise( lua_State *L )
 {
+    DM_PROFILE("gltfloader.perlinnoise");
     DM_LUA_STACK_CHECK(L, 1);
     float x = luaL_checknumber(L, 1);
     float y = luaL_checknumber(L, 2);
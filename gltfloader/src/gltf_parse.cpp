@@ -0,0 +1,164 @@
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#include "tiny_gltf.h"
+#include "image_decode.h"
+#include "mesh_cache.h"
+#include "gltf_parse.h"
+#include "gltf_profile.h"
+#include "json_arena.h"
+
+static bool IsBinaryGltf( const std::string &filename )
+{
+    size_t dot = filename.find_last_of('.');
+    return dot != std::string::npos && filename.compare(dot + 1, std::string::npos, "glb") == 0;
+}
+
+static uint64_t GetTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static GltfReadFileFunc  g_readfunc = 0;
+static void             *g_readctx = 0;
+
+void SetGltfFileReader( GltfReadFileFunc func, void *ctx )
+{
+    g_readfunc = func;
+    g_readctx = ctx;
+}
+
+bool ReadGltfFile( const char *path, std::vector<unsigned char> *out, std::string *err )
+{
+    return tinygltf::ReadWholeFile(out, err, path, 0);
+}
+
+bool ReadModelFile( const char *path, std::vector<unsigned char> *out, std::string *err )
+{
+    if( g_readfunc ) return g_readfunc(path, out, err, g_readctx);
+    return ReadGltfFile(path, out, err);
+}
+
+// tinygltf asks whether an external file exists, then its size, then reads it.
+// The exists call reads the whole file in one go and the other two are answered
+// from it, so every file costs one read (one archive lookup in a bundle).
+typedef struct ParseFiles {
+    ParseStats                  *stats;
+    std::string                 path;       // The file in data, if found
+    std::vector<unsigned char>  data;
+    bool                        found;
+} ParseFiles;
+
+static bool FetchFile( ParseFiles *files, const std::string &path, std::string *err )
+{
+    if( files->found && files->path == path ) return true;
+
+    GLTF_PROFILE("GltfReadFile");
+    uint64_t start = GetTimeUs();
+    std::string readerr;
+    files->data.clear();
+    files->found = ReadModelFile(path.c_str(), &files->data, &readerr);
+    files->path = path;
+    files->stats->read += GetTimeUs() - start;
+    if( files->found ) files->stats->bytesread += files->data.size();
+    else if( err ) *err += readerr;
+    return files->found;
+}
+
+static bool FileExistsCb( const std::string &path, void *user_data )
+{
+    return FetchFile((ParseFiles *)user_data, path, 0);
+}
+
+static bool GetFileSizeCb( size_t *size, std::string *err, const std::string &path, void *user_data )
+{
+    ParseFiles *files = (ParseFiles *)user_data;
+    if( !FetchFile(files, path, err) ) return false;
+    *size = files->data.size();
+    return true;
+}
+
+// Hands the data over, a file is only read once per parse
+static bool ReadWholeFileCb( std::vector<unsigned char> *out, std::string *err, const std::string &path, void *user_data )
+{
+    ParseFiles *files = (ParseFiles *)user_data;
+    if( !FetchFile(files, path, err) ) return false;
+    out->swap(files->data);
+    files->data.clear();
+    files->path.clear();
+    files->found = false;
+    return true;
+}
+
+bool ParseGltf( const char *gltf_filename, uint32_t flags, tinygltf::Model &model,
+                std::string *err, std::string *warn, bool *cached, ParseStats *stats )
+{
+    GLTF_PROFILE("GltfParse");
+    uint64_t start = GetTimeUs();
+    ParseStats localstats;
+    if( !stats ) stats = &localstats;
+    memset(stats, 0, sizeof(*stats));
+    if( cached ) *cached = false;
+
+    // A bake skips the json parse and accessor conversion. gltfbake output next to
+    // the file is read through the file reader, the cache of sources on disk lives
+    // in its own directory so it never ends up in a bundle.
+    uint64_t sourcesize = 0, sourcemtime = 0;
+    bool usecache = !(flags & LOAD_NO_CACHE);
+    bool ondisk = GetSourceStamp(gltf_filename, &sourcesize, &sourcemtime);
+    std::string bakepath = GetMeshCachePath(gltf_filename);
+    std::string cachepath = GetRuntimeCachePath(gltf_filename);
+    bool hit = false;
+    if( usecache )
+    {
+        GLTF_PROFILE("GltfReadCache");
+        hit = ReadMeshCache(bakepath.c_str(), gltf_filename, model);
+        if( !hit && ondisk ) hit = ReadMeshCache(cachepath.c_str(), gltf_filename, model);
+    }
+    if( hit )
+    {
+        if( cached ) *cached = true;
+        stats->total = GetTimeUs() - start;
+        return true;
+    }
+
+    tinygltf::TinyGLTF gltf_ctx;
+    std::string input_filename(gltf_filename);
+
+    // Images are only staged during the parse, they get decoded in parallel afterwards
+    gltf_ctx.SetImageLoader(StageImageData, 0);
+    ParseFiles files;
+    files.stats = stats;
+    files.found = false;
+    tinygltf::FsCallbacks fs = { FileExistsCb, &tinygltf::ExpandFilePath, ReadWholeFileCb,
+                                 &tinygltf::WriteWholeFile, GetFileSizeCb, &files };
+    gltf_ctx.SetFsCallbacks(fs);
+
+    // The json DOM only lives inside the Load call, it is dropped with the arena
+    bool ret;
+    BeginJsonArena();
+    if( IsBinaryGltf(input_filename) )
+        ret = gltf_ctx.LoadBinaryFromFile(&model, err, warn, input_filename.c_str());
+    else
+        ret = gltf_ctx.LoadASCIIFromFile(&model, err, warn, input_filename.c_str());
+    EndJsonArena();
+    if( !ret ) return false;
+
+    // Images are still encoded here, which is what the cache stores. Models the
+    // cache can't hold without loss are parsed every time. A stale gltfbake output
+    // is left for the tool to redo (it may hold lods or quantized streams).
+    if( usecache && ondisk && IsToolBake(bakepath.c_str()) && warn )
+        *warn += bakepath + " is out of date, rebake it with gltfbake\n";
+    if( usecache && ondisk && CanBakeModel(model, 0) )
+    {
+        GLTF_PROFILE("GltfWriteCache");
+        std::string cacheerr;
+        if( !WriteMeshCache(model, cachepath.c_str(), gltf_filename, &cacheerr) && warn )
+            *warn += cacheerr + "\n";
+    }
+    stats->total = GetTimeUs() - start;
+    return true;
+}
@@ -11,11 +11,31 @@
 #include <dmsdk/sdk.h>
 
 #include "geom.h"
+#include "jobs.h"
+#include "image_decode.h"
+#include "accessor.h"
+#include "mesh.h"
+#include "mesh_buffer.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+#include "mesh_batch.h"
+#include "lod_manager.h"
+#include "instances.h"
+#include "mesh_pool.h"
+#include "spawn_queue.h"
+#include "scene.h"
+#include "model_stats.h"
+#include "model_describe.h"
+#include "animation.h"
+#include "tinygltf_loader.h"
 #include "tiny_gltf.h"
+#include "gltf_profile.h"
 
-extern int load_gltf(const char *gltf_filename, bool dump);
-extern void InitMeshBuilding(dmResource::HFactory _Factory, dmConfigFile::HConfig _ConfigFile);
-extern void DestroyMeshBuilding();
+// Per frame counters, the profiler shows them under "glTF loader"
+DM_PROPERTY_GROUP(rmtp_GltfLoader, "glTF loader", 0);
+DM_PROPERTY_U32(rmtp_GltfBytesConverted, 0, PROFILE_PROPERTY_FRAME_RESET, "# bytes converted from accessors", &rmtp_GltfLoader);
+DM_PROPERTY_U32(rmtp_GltfRaysTested, 0, PROFILE_PROPERTY_FRAME_RESET, "# rays cast at the bounding boxes", &rmtp_GltfLoader);
+DM_PROPERTY_U32(rmtp_GltfBoxesVisited, 0, PROFILE_PROPERTY_FRAME_RESET, "# bounding boxes tested by those rays", &rmtp_GltfLoader);
 
 
 static void GetTableNumbersInt( lua_State * L, int tblidx, int *data )
@@ -42,132 +62,142 @@ static void GetTableNumbersFloat( lua_State * L, int tblidx, float *data )
     }
 }
 
-static int SetDataShortsToTable(lua_State* L)
+// All the setdata*totable calls share this. Args are:
+//   offset, length (bytes of packed values), data string, table [, stride, components, normalized]
+//   A stride of 0 means the values are tightly packed.
+static int SetDataToTable(lua_State* L, int componentType)
 {
     DM_LUA_STACK_CHECK(L, 0);
     unsigned int offset = luaL_checknumber(L, 1);
     unsigned int length = luaL_checknumber(L, 2);
-    const unsigned char *data = (unsigned char *)luaL_checkstring(L, 3);
+    size_t datalen = 0;
+    const unsigned char *data = (const unsigned char *)luaL_checklstring(L, 3, &datalen);
     luaL_checktype(L, 4, LUA_TTABLE);
 
-    assert(length > 0);
-    
-    // Now we have the data, cast it to the union and write back out.
-    int idx = 1;
-    unsigned short *ptr = (unsigned short *)&data[offset];
-    for( unsigned int i=0; i<length; i+=sizeof(unsigned short), ptr++)
-    {
-        unsigned int val = ( unsigned int )*ptr;
-        //printf("%d\n", val);
-        lua_pushnumber(L, val);  /* value */
-        lua_rawseti(L, 4, idx++);  /* set table at key `i' */
-    }
+    int top = lua_gettop(L);
+    unsigned int stride = (top > 4) ? luaL_checknumber(L, 5) : 0;
+    unsigned int components = (top > 5) ? luaL_checknumber(L, 6) : 1;
+    bool normalized = (top > 6) ? lua_toboolean(L, 7) : false;
+    if(components == 0) components = 1;
 
-    return 0;
-}
+    AccessorView view;
+    view.componentType = componentType;
+    view.components = components;
+    view.normalized = normalized;
+    view.stride = (stride > 0) ? stride : ComponentSize(componentType) * components;
+    view.count = length / (ComponentSize(componentType) * components);
+    view.data = data + offset;
+    if(view.count == 0) return 0;
 
-static int SetDataBytesToTable(lua_State* L)
-{
-    DM_LUA_STACK_CHECK(L, 0);
-    unsigned int offset = luaL_checknumber(L, 1);
-    unsigned int length = luaL_checknumber(L, 2);
-    const unsigned char *data = (unsigned char *)luaL_checkstring(L, 3);
-    luaL_checktype(L, 4, LUA_TTABLE);
-
-    assert(length > 0);
+    if(offset > datalen || AccessorViewExtent(view) > datalen - offset)
+        return DM_LUA_ERROR("Data range out of bounds (offset %u, length %u, data %u bytes)", offset, length, (unsigned int)datalen);
 
-    // Now we have the data, cast it to the union and write back out.
+    size_t n = view.count * view.components;
     int idx = 1;
-    unsigned char *ptr = (unsigned char *)&data[offset];
-    for( unsigned int i=0; i<length; i+=sizeof(unsigned char), ptr++)
+    if(componentType == TINYGLTF_COMPONENT_TYPE_FLOAT || normalized)
+    {
+        std::vector<float> values(n);
+        ConvertToFloat(view, &values[0]);
+        for( size_t i=0; i<n; i++)
+        {
+            lua_pushnumber(L, values[i]);  /* value */
+            lua_rawseti(L, 4, idx++);  /* set table at key `i' */
+        }
+    }
+    else 
     {
-        unsigned int val = ( unsigned int )*ptr;
-        //printf("%d\n", val);
-        lua_pushnumber(L, val);  /* value */
-        lua_rawseti(L, 4, idx++);  /* set table at key `i' */
+        std::vector<uint32_t> values(n);
+        ConvertToU32(view, &values[0]);
+        for( size_t i=0; i<n; i++)
+        {
+            lua_pushnumber(L, values[i]);  /* value */
+            lua_rawseti(L, 4, idx++);  /* set table at key `i' */
+        }
     }
 
     return 0;
 }
 
-static int SetDataIntsToTable(lua_State* L)
+static int SetDataShortsToTable(lua_State* L)
 {
-    DM_LUA_STACK_CHECK(L, 0);
-    unsigned int offset = luaL_checknumber(L, 1);
-    unsigned int length = luaL_checknumber(L, 2);
-    const unsigned char *data = (unsigned char *)luaL_checkstring(L, 3);
-    luaL_checktype(L, 4, LUA_TTABLE);
+    DM_PROFILE("gltfloader.setdatashortstotable");
+    return SetDataToTable(L, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+}
 
-    assert(length > 0);
-    
-    // Now we have the data, cast it to the union and write back out.
-    int idx = 1;
-    unsigned int *ptr = (unsigned int *)&data[offset];
-    for( unsigned int i=0; i<length; i+=sizeof(unsigned int), ptr++)
-    {
-        unsigned int val = *ptr;
-        //printf("%d\n", val);
-        lua_pushnumber(L, val);  /* value */
-        lua_rawseti(L, 4, idx++);  /* set table at key `i' */
-    }
+static int SetDataBytesToTable(lua_State* L)
+{
+    DM_PROFILE("gltfloader.setdatabytestotable");
+    return SetDataToTable(L, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE);
+}
 
-    return 0;
+static int SetDataIntsToTable(lua_State* L)
+{
+    DM_PROFILE("gltfloader.setdataintstotable");
+    return SetDataToTable(L, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT);
 }
 
 static int SetDataFloatsToTable(lua_State* L)
 {
-    DM_LUA_STACK_CHECK(L, 0);
-    unsigned int offset = luaL_checknumber(L, 1);
-    unsigned int length = luaL_checknumber(L, 2);
-    const char *data = luaL_checkstring(L, 3);
-    luaL_checktype(L, 4, LUA_TTABLE);
-    
-    assert(length > 0);
-
-    // Now we have the data, cast it to the union and write back out.
-    unsigned int idx = 1;
-    float *ptr = (float *)&data[offset];
-    for( unsigned int i=0; i<length; i+= sizeof(float), ptr++)
-    {
-        float val = *ptr;
-        lua_pushnumber(L, val);  /* value */
-        lua_rawseti(L, 4, idx++);  /* set table at key `i' */
-    }
-
-    return 0;
+    DM_PROFILE("gltfloader.setdatafloatstotable");
+    return SetDataToTable(L, TINYGLTF_COMPONENT_TYPE_FLOAT);
 }
 
+// Args are: data string, table, indices table, components per index
+//   [, componentType, normalized]. The data is tightly packed floats unless a
+//   componentType is given, normalized byte/short data is mapped to [0,1] / [-1,1].
 static int SetDataIndexFloatsToTable(lua_State* L)
 {
+    DM_PROFILE("gltfloader.setdataindexfloatstotable");
     DM_LUA_STACK_CHECK(L, 0);
-    const char *data = luaL_checkstring(L, 1);
+    size_t datalen = 0;
+    const unsigned char *data = (const unsigned char *)luaL_checklstring(L, 1, &datalen);
     luaL_checktype(L, 2, LUA_TTABLE);
-    luaL_checktype(L, 3, LUA_TTABLE);       // This is the indices tables. 
+    luaL_checktype(L, 3, LUA_TTABLE);       // This is the indices tables.
     unsigned int elements = luaL_checknumber(L, 4); // How many floats per index
 
+    int top = lua_gettop(L);
+    int componentType = (top > 4) ? luaL_checknumber(L, 5) : TINYGLTF_COMPONENT_TYPE_FLOAT;
+    bool normalized = (top > 5) ? lua_toboolean(L, 6) : false;
+    if(elements == 0 || ComponentSize(componentType) == 0)
+        return DM_LUA_ERROR("Invalid components %u or component type %d", elements, componentType);
+
+    AccessorView view;
+    view.componentType = componentType;
+    view.components = elements;
+    view.normalized = normalized;
+    view.stride = ComponentSize(componentType) * elements;
+    view.count = datalen / view.stride;
+    view.data = data;
+
     size_t indiceslen = lua_objlen(L, 3);
-    int * idata = (int *)calloc(indiceslen, sizeof(int));    
-    GetTableNumbersInt(L, 3, idata);
+    if(indiceslen == 0 || view.count == 0) return 0;
+    std::vector<int> idata(indiceslen);
+    GetTableNumbersInt(L, 3, &idata[0]);
+    for(size_t i=0; i<indiceslen; i++)
+    {
+        if(idata[i] < 0 || (size_t)idata[i] >= view.count)
+            return DM_LUA_ERROR("Index %d out of range (%u elements)", idata[i], (unsigned int)view.count);
+    }
+
+    std::vector<float> values(view.count * elements);
+    ConvertToFloat(view, &values[0]);
 
-    // Now we have the data, cast it to the union and write back out.
     unsigned int idx = 1;
-    float *ptr = (float *)&data[0];
-    for( unsigned int i=0; i<indiceslen; i++)
+    for( size_t i=0; i<indiceslen; i++)
     {
-        for( int j=0; j< elements; j++)
+        const float *ptr = &values[idata[i] * elements];
+        for( unsigned int j=0; j<elements; j++)
         {
-            float val = ptr[idata[i] * elements + j];
-            lua_pushnumber(L, val);  /* value */
+            lua_pushnumber(L, ptr[j]);  /* value */
             lua_rawseti(L, 2, idx++);  /* set table at key `i' */
         }
     }
-
-    free(idata);
     return 0;
 }
 
 static int SetBufferBytesFromTable(lua_State* L)
 {
+    DM_PROFILE("gltfloader.setbufferbytesfromtable");
     DM_LUA_STACK_CHECK(L, 0);
     dmScript::LuaHBuffer *buffer = dmScript::CheckBuffer(L, 1);
     const char *streamname = luaL_checkstring(L, 2);
@@ -212,6 +242,7 @@ static int SetBufferBytesFromTable(lua_State* L)
 
 static int SetBufferBytes(lua_State* L)
 {
+    DM_PROFILE("gltfloader.setbufferbytes");
     DM_LUA_STACK_CHECK(L, 0);
     dmScript::LuaHBuffer *buffer = dmScript::CheckBuffer(L, 1);
     const char *streamname = luaL_checkstring(L, 2);
@@ -244,6 +275,7 @@ static int SetBufferBytes(lua_State* L)
 
 static int BuildIndicesToTable(lua_State *L)
 {
+    DM_PROFILE("gltfloader.buildindicestotable");
     DM_LUA_STACK_CHECK(L, 0);
     int start = luaL_checknumber(L, 1);
     int length = luaL_checknumber(L, 2);
@@ -284,16 +316,1116 @@ static int BuildIndicesToTable(lua_State *L)
 
 static int LoadGltf(lua_State *L)
 {
+    DM_PROFILE("gltfloader.loadgltf");
     const char * input_filename = luaL_checkstring(L, 1);
     bool dumpfile = false;
+    uint32_t flags = 0;
     int n = lua_gettop(L);
     if(n > 1) dumpfile = (luaL_checknumber(L, 2) == 1)?true:false;
-    int ret = load_gltf(input_filename, dumpfile);
+    if(n > 2) flags = (uint32_t)luaL_checknumber(L, 3);
+    int ret = load_gltf(input_filename, dumpfile, flags);
 
     lua_pushnumber(L, ret);
     return 1;
 }
 
+// Returns the pixels of a model image as a buffer, width, height.
+//   Images from a lazy load are decoded here the first time they are asked for.
+static int GetImage(lua_State *L)
+{
+    DM_PROFILE("gltfloader.get_image");
+    DM_LUA_STACK_CHECK(L, 3);
+    int modelid = luaL_checknumber(L, 1);
+    int imageidx = luaL_checknumber(L, 2);
+
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0) 
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(imageidx < 0 || imageidx >= (int)model->images.size())
+        return DM_LUA_ERROR("Invalid image index: %d", imageidx);
+
+    tinygltf::Image &image = model->images[imageidx];
+    std::string err;
+    if(!DecodeImage(image, imageidx, &err) || image.image.empty())
+    {
+        dmLogError("Failed to decode image %d: %s", imageidx, err.c_str());
+        lua_pushnil(L);
+        lua_pushnil(L);
+        lua_pushnil(L);
+        return 3;
+    }
+
+    dmBuffer::ValueType valuetype = (image.bits == 16) ? dmBuffer::VALUE_TYPE_UINT16 : dmBuffer::VALUE_TYPE_UINT8;
+    dmBuffer::HBuffer buffer;
+    dmBuffer::StreamDeclaration streams_decl[] = {
+        { dmHashString64("pixels"), valuetype, (uint8_t)image.component }
+    };
+    dmBuffer::Result r = dmBuffer::Create(image.width * image.height, streams_decl, 1, &buffer);
+    if (r != dmBuffer::RESULT_OK) 
+    {
+        lua_pushnil(L);
+        lua_pushnil(L);
+        lua_pushnil(L);
+        return 3;
+    }
+
+    uint8_t* data = 0;
+    uint32_t datasize = 0;
+    dmBuffer::GetBytes(buffer, (void**)&data, &datasize);
+    memcpy(data, &image.image[0], std::min((size_t)datasize, image.image.size()));
+    dmBuffer::ValidateBuffer(buffer);
+
+    dmScript::LuaHBuffer luabuffer(buffer, dmScript::OWNER_LUA);
+    dmScript::PushBuffer(L, luabuffer);
+    lua_pushnumber(L, image.width);
+    lua_pushnumber(L, image.height);
+    return 3;
+}
+
+// Returns the model space min, max of a mesh (all its primitives). If a tag 
+//   is passed the box is also added to the raycast list and its index returned
+//   (nil otherwise).
+static int GetBounds(lua_State *L)
+{
+    DM_PROFILE("gltfloader.get_bounds");
+    DM_LUA_STACK_CHECK(L, 3);
+    int top = lua_gettop(L);
+    int modelid = luaL_checknumber(L, 1);
+    int meshidx = luaL_checknumber(L, 2);
+
+    DefoldModel *dmodel = GetDefoldModel(modelid);
+    if(dmodel == 0) 
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(meshidx < 0 || meshidx >= (int)dmodel->bounds.size())
+        return DM_LUA_ERROR("Invalid mesh index: %d", meshidx);
+
+    PrimitiveBounds bounds;
+    if(!MergeBounds(dmodel->bounds[meshidx], &bounds))
+    {
+        lua_pushnil(L);
+        lua_pushnil(L);
+        lua_pushnil(L);
+        return 3;
+    }
+
+    dmScript::PushVector3(L, dmVMath::Vector3(bounds.min[0], bounds.min[1], bounds.min[2]));
+    dmScript::PushVector3(L, dmVMath::Vector3(bounds.max[0], bounds.max[1], bounds.max[2]));
+    if(top > 2)
+    {
+        uint64_t tag = dmScript::CheckHash(L, 3);
+        int index = AddBounds(Vec3(bounds.min[0], bounds.min[1], bounds.min[2]), Vec3(bounds.max[0], bounds.max[1], bounds.max[2]), tag);
+        lua_pushnumber(L, index);
+    }
+    else
+        lua_pushnil(L);
+    return 3;
+}
+
+static void SetFieldNumber(lua_State *L, const char *name, double value)
+{
+    lua_pushnumber(L, value);
+    lua_setfield(L, -2, name);
+}
+
+static void PushModelMemory(lua_State *L, const ModelMemory &memory)
+{
+    lua_createtable(L, 0, 5);
+    SetFieldNumber(L, "buffers", memory.buffers);
+    SetFieldNumber(L, "images", memory.images);
+    SetFieldNumber(L, "accessors", memory.accessors);
+    SetFieldNumber(L, "structures", memory.structures);
+    SetFieldNumber(L, "total", memory.total);
+}
+
+// { memory = { buffers, images, accessors, structures, total } (bytes),
+//   timings = { parse, read, images, total } (ms), cached,
+//   meshes, primitives, nodes, vertices, triangles, images, textures }
+static int ModelStats(lua_State *L)
+{
+    DM_PROFILE("gltfloader.model_stats");
+    DM_LUA_STACK_CHECK(L, 1);
+    int modelid = luaL_checknumber(L, 1);
+    DefoldModel *dmodel = GetDefoldModel(modelid);
+    if(dmodel == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+
+    ModelMemory memory;
+    GetModelMemory(dmodel->model, &memory);
+    ModelGeometry geometry;
+    GetModelGeometry(dmodel->model, &geometry);
+    const LoadTimings &timings = dmodel->timings;
+
+    lua_createtable(L, 0, 10);
+    PushModelMemory(L, memory);
+    lua_setfield(L, -2, "memory");
+
+    lua_createtable(L, 0, 4);
+    SetFieldNumber(L, "parse", (timings.parse.total - timings.parse.read) / 1000.0);
+    SetFieldNumber(L, "read", timings.parse.read / 1000.0);
+    SetFieldNumber(L, "images", timings.images / 1000.0);
+    SetFieldNumber(L, "total", timings.total / 1000.0);
+    lua_setfield(L, -2, "timings");
+    lua_pushboolean(L, timings.cached);
+    lua_setfield(L, -2, "cached");
+
+    SetFieldNumber(L, "meshes", geometry.meshes);
+    SetFieldNumber(L, "primitives", geometry.primitives);
+    SetFieldNumber(L, "nodes", geometry.nodes);
+    SetFieldNumber(L, "vertices", geometry.vertices);
+    SetFieldNumber(L, "triangles", geometry.triangles);
+    SetFieldNumber(L, "images", dmodel->model.images.size());
+    SetFieldNumber(L, "textures", dmodel->model.textures.size());
+    return 1;
+}
+
+// Totals over all loaded models: { models, memory = { ... }, vertices, triangles, load_ms }
+static int Stats(lua_State *L)
+{
+    DM_PROFILE("gltfloader.stats");
+    DM_LUA_STACK_CHECK(L, 1);
+    ModelMemory total = {};
+    uint64_t vertices = 0, triangles = 0, loadtime = 0;
+    int count = GetModelCount();
+    for(int i = 0; i < count; ++i)
+    {
+        DefoldModel *dmodel = GetDefoldModel(i);
+        ModelMemory memory;
+        GetModelMemory(dmodel->model, &memory);
+        total.buffers += memory.buffers;
+        total.images += memory.images;
+        total.accessors += memory.accessors;
+        total.structures += memory.structures;
+        total.total += memory.total;
+
+        ModelGeometry geometry;
+        GetModelGeometry(dmodel->model, &geometry);
+        vertices += geometry.vertices;
+        triangles += geometry.triangles;
+        loadtime += dmodel->timings.total;
+    }
+
+    lua_createtable(L, 0, 5);
+    SetFieldNumber(L, "models", count);
+    PushModelMemory(L, total);
+    lua_setfield(L, -2, "memory");
+    SetFieldNumber(L, "vertices", vertices);
+    SetFieldNumber(L, "triangles", triangles);
+    SetFieldNumber(L, "load_ms", loadtime / 1000.0);
+    return 1;
+}
+
+// Builds the describe tables as the model is walked. Every open table keeps
+//   the key it goes into, or counts its elements if it is an array.
+typedef struct LuaDescribeFrame
+{
+    const char  *key;
+    bool        array;
+    int         count;
+} LuaDescribeFrame;
+
+typedef struct LuaDescribe
+{
+    lua_State                       *L;
+    std::vector<LuaDescribeFrame>   frames;
+} LuaDescribe;
+
+// Sets the value on top of the stack into the table below it
+static void LuaDescribeSet(LuaDescribe *describe, const char *key)
+{
+    if(describe->frames.empty())
+        return;
+    LuaDescribeFrame &parent = describe->frames.back();
+    if(parent.array)
+        lua_rawseti(describe->L, -2, ++parent.count);
+    else
+        lua_setfield(describe->L, -2, key);
+}
+
+static void LuaDescribeBegin(void *ctx, const char *key, bool array)
+{
+    LuaDescribe *describe = (LuaDescribe *)ctx;
+    // Every open table stays on the stack, extras can nest deeper than it has room for
+    luaL_checkstack(describe->L, 2, "model too deeply nested");
+    lua_newtable(describe->L);
+    LuaDescribeFrame frame = { key, array, 0 };
+    describe->frames.push_back(frame);
+}
+
+static void LuaDescribeEnd(void *ctx, bool array)
+{
+    LuaDescribe *describe = (LuaDescribe *)ctx;
+    const char *key = describe->frames.back().key;
+    describe->frames.pop_back();
+    LuaDescribeSet(describe, key);
+}
+
+static void LuaDescribeNumber(void *ctx, const char *key, double value)
+{
+    LuaDescribe *describe = (LuaDescribe *)ctx;
+    lua_pushnumber(describe->L, value);
+    LuaDescribeSet(describe, key);
+}
+
+static void LuaDescribeString(void *ctx, const char *key, const char *value)
+{
+    LuaDescribe *describe = (LuaDescribe *)ctx;
+    lua_pushstring(describe->L, value);
+    LuaDescribeSet(describe, key);
+}
+
+static void LuaDescribeBoolean(void *ctx, const char *key, bool value)
+{
+    LuaDescribe *describe = (LuaDescribe *)ctx;
+    lua_pushboolean(describe->L, value);
+    LuaDescribeSet(describe, key);
+}
+
+// describe(model_id) returns the model summary as a table (see model_describe.h),
+//   describe(model_id, path) writes it to the file as compact json instead.
+static int Describe(lua_State *L)
+{
+    DM_PROFILE("gltfloader.describe");
+    DM_LUA_STACK_CHECK(L, 1);
+    int modelid = luaL_checknumber(L, 1);
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+
+    if(lua_gettop(L) > 1)
+    {
+        const char *path = luaL_checkstring(L, 2);
+        FILE *file = fopen(path, "wb");
+        if(file == 0)
+            return DM_LUA_ERROR("Could not open %s", path);
+        bool ok = WriteModelDescription(*model, file);
+        ok = fclose(file) == 0 && ok;
+        if(!ok)
+            return DM_LUA_ERROR("Could not write %s", path);
+        lua_pushboolean(L, 1);
+        return 1;
+    }
+
+    LuaDescribe describe;
+    describe.L = L;
+    DescribeWriter writer = { &describe, LuaDescribeBegin, LuaDescribeEnd, LuaDescribeNumber, LuaDescribeString, LuaDescribeBoolean };
+    DescribeModel(*model, &writer);
+    return 1;
+}
+
+// Expands an indexed primitive straight into the float streams of a buffer
+//   (position, normal, texcoord0 ...). Returns the number of vertices written.
+static int Unindex(lua_State *L)
+{
+    DM_PROFILE("gltfloader.unindex");
+    DM_LUA_STACK_CHECK(L, 1);
+    int modelid = luaL_checknumber(L, 1);
+    int meshidx = luaL_checknumber(L, 2);
+    int primidx = luaL_checknumber(L, 3);
+    dmScript::LuaHBuffer *buffer = dmScript::CheckBuffer(L, 4);
+
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(meshidx < 0 || meshidx >= (int)model->meshes.size())
+        return DM_LUA_ERROR("Invalid mesh index: %d", meshidx);
+    const tinygltf::Mesh &mesh = model->meshes[meshidx];
+    if(primidx < 0 || primidx >= (int)mesh.primitives.size())
+        return DM_LUA_ERROR("Invalid primitive index: %d", primidx);
+    const tinygltf::Primitive &prim = mesh.primitives[primidx];
+
+    std::vector<uint32_t> indices;
+    if(!GetTriangleIndices(*model, prim, indices))
+        return DM_LUA_ERROR("Primitive %d of mesh %d is not a triangle primitive", primidx, meshidx);
+
+    // Attributes are converted to packed floats once, then gathered together
+    std::vector<float> sources[8];
+    GatherStream streams[8];
+    int numstreams = 0;
+    uint32_t vertexcount = 0xffffffff;
+    uint32_t buffercount = 0;
+    dmBuffer::GetCount(buffer->m_Buffer, &buffercount);
+
+    for(const StreamAttribute *sa = g_StreamAttributes; sa->stream && numstreams < 8; ++sa)
+    {
+        float* bytes = 0x0;
+        uint32_t count = 0;
+        uint32_t components = 0;
+        uint32_t stride = 0;
+        dmBuffer::ValueType valuetype;
+        dmhash_t streamname = dmHashString64(sa->stream);
+        if(dmBuffer::GetStreamType(buffer->m_Buffer, streamname, &valuetype, &components) != dmBuffer::RESULT_OK)
+            continue;
+        if(valuetype != dmBuffer::VALUE_TYPE_FLOAT32)
+        {
+            dmLogWarning("Stream '%s' is not float32, skipping it", sa->stream);
+            continue;
+        }
+        if(dmBuffer::GetStream(buffer->m_Buffer, streamname, (void**)&bytes, &count, &components, &stride) != dmBuffer::RESULT_OK)
+            continue;
+
+        int srccomponents = GetAttributeFloats(*model, prim, sa->attribute, sources[numstreams]);
+        if(srccomponents == 0)
+            continue;
+
+        GatherStream &stream = streams[numstreams];
+        stream.src = &sources[numstreams][0];
+        stream.srccomponents = srccomponents;
+        stream.dst = bytes;
+        stream.dstcomponents = components;
+        stream.dststride = stride;
+        vertexcount = std::min(vertexcount, (uint32_t)(sources[numstreams].size() / srccomponents));
+        numstreams++;
+    }
+
+    if(numstreams == 0 || indices.empty())
+    {
+        lua_pushnumber(L, 0);
+        return 1;
+    }
+
+    // A bad index would read past the converted attributes
+    for(size_t i=0; i<indices.size(); ++i)
+    {
+        if(indices[i] >= vertexcount)
+            return DM_LUA_ERROR("Index %u out of range (%u vertices)", indices[i], vertexcount);
+    }
+
+    size_t count = std::min((size_t)buffercount, indices.size());
+    if(count < indices.size())
+        dmLogWarning("Buffer holds %u vertices, primitive needs %u", buffercount, (uint32_t)indices.size());
+
+    GatherVertices(&indices[0], count, streams, numstreams);
+    dmBuffer::ValidateBuffer(buffer->m_Buffer);
+
+    lua_pushnumber(L, count);
+    return 1;
+}
+
+// Builds an indexed mesh from a primitive. Returns a vertex buffer (one float
+//   stream per attribute, shared vertices) and an index buffer ("indices", u16/u32).
+//   With optimize set the triangles and vertices are reordered for the vertex cache
+//   and the ACMR before and after is returned as well.
+static int BuildMesh(lua_State *L)
+{
+    DM_PROFILE("gltfloader.build_mesh");
+    int modelid = luaL_checknumber(L, 1);
+    int meshidx = luaL_checknumber(L, 2);
+    int primidx = luaL_checknumber(L, 3);
+    bool optimize = lua_toboolean(L, 4);
+
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(meshidx < 0 || meshidx >= (int)model->meshes.size())
+        return DM_LUA_ERROR("Invalid mesh index: %d", meshidx);
+    const tinygltf::Mesh &mesh = model->meshes[meshidx];
+    if(primidx < 0 || primidx >= (int)mesh.primitives.size())
+        return DM_LUA_ERROR("Invalid primitive index: %d", primidx);
+
+    MeshData meshdata;
+    if(!BuildMeshData(*model, mesh.primitives[primidx], meshdata))
+    {
+        dmLogError("Failed to build mesh %d primitive %d", meshidx, primidx);
+        lua_pushnil(L);
+        lua_pushnil(L);
+        return 2;
+    }
+
+    if(!optimize)
+    {
+        PushMeshBuffers(L, meshdata);
+        return 2;
+    }
+
+    MeshOptimizeStats stats;
+    OptimizeMesh(meshdata, &stats);
+    dmLogInfo("Mesh %d primitive %d ACMR %.3f -> %.3f", meshidx, primidx, stats.acmrbefore, stats.acmrafter);
+
+    PushMeshBuffers(L, meshdata);
+    lua_pushnumber(L, stats.acmrbefore);
+    lua_pushnumber(L, stats.acmrafter);
+    return 4;
+}
+
+// Generates simplified versions of a mesh primitive, one per ratio (fraction of
+//   triangles kept). Returns a table of buffers ready for a mesh component and a
+//   table with the triangle count of each.
+static int BuildLods(lua_State *L)
+{
+    DM_PROFILE("gltfloader.build_lods");
+    DM_LUA_STACK_CHECK(L, 2);
+    int modelid = luaL_checknumber(L, 1);
+    int meshidx = luaL_checknumber(L, 2);
+    luaL_checktype(L, 3, LUA_TTABLE);
+    int primidx = (lua_gettop(L) > 3) ? luaL_checknumber(L, 4) : 0;
+
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(meshidx < 0 || meshidx >= (int)model->meshes.size())
+        return DM_LUA_ERROR("Invalid mesh index: %d", meshidx);
+    const tinygltf::Mesh &mesh = model->meshes[meshidx];
+    if(primidx < 0 || primidx >= (int)mesh.primitives.size())
+        return DM_LUA_ERROR("Invalid primitive index: %d", primidx);
+
+    size_t ratioslen = lua_objlen(L, 3);
+    std::vector<float> ratios(ratioslen);
+    if(ratioslen > 0) GetTableNumbersFloat(L, 3, &ratios[0]);
+
+    MeshData meshdata;
+    if(!BuildMeshData(*model, mesh.primitives[primidx], meshdata))
+    {
+        dmLogError("Failed to build mesh %d primitive %d", meshidx, primidx);
+        lua_pushnil(L);
+        lua_pushnil(L);
+        return 2;
+    }
+
+    lua_createtable(L, ratioslen, 0);
+    lua_createtable(L, ratioslen, 0);
+    for(size_t i=0; i<ratioslen; ++i)
+    {
+        MeshData lod;
+        size_t triangles = SimplifyMesh(meshdata, ratios[i], lod);
+        OptimizeMesh(lod, 0);
+
+        dmBuffer::HBuffer buffer = 0;
+        if(CreateUnindexedBuffer(lod, &buffer))
+        {
+            dmScript::LuaHBuffer luabuffer(buffer, dmScript::OWNER_LUA);
+            dmScript::PushBuffer(L, luabuffer);
+        }
+        else
+            lua_pushboolean(L, 0);
+        lua_rawseti(L, -3, i + 1);
+
+        lua_pushnumber(L, triangles);
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 2;
+}
+
+// Merges every primitive of a scene that shares a material into one mesh with the
+//   node transforms baked in. Returns a list of { material, vertices (buffer for a
+//   mesh component), ranges = { { node, mesh, primitive, first, count } ... } }
+//   where first/count are vertices in the buffer, so a source part can be found again.
+static int BuildStaticBatch(lua_State *L)
+{
+    DM_PROFILE("gltfloader.build_static_batch");
+    DM_LUA_STACK_CHECK(L, 1);
+    int modelid = luaL_checknumber(L, 1);
+    int scene = (lua_gettop(L) > 1) ? luaL_checknumber(L, 2) : -1;
+
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(scene >= (int)model->scenes.size())
+        return DM_LUA_ERROR("Invalid scene index: %d", scene);
+
+    std::vector<StaticBatch> batches;
+    BuildStaticBatches(*model, scene, batches);
+
+    lua_createtable(L, batches.size(), 0);
+    for(size_t b=0; b<batches.size(); ++b)
+    {
+        const StaticBatch &batch = batches[b];
+        lua_createtable(L, 0, 3);
+
+        lua_pushnumber(L, batch.material);
+        lua_setfield(L, -2, "material");
+
+        dmBuffer::HBuffer buffer = 0;
+        if(CreateUnindexedBuffer(batch.mesh, &buffer))
+        {
+            dmScript::LuaHBuffer luabuffer(buffer, dmScript::OWNER_LUA);
+            dmScript::PushBuffer(L, luabuffer);
+        }
+        else
+            lua_pushboolean(L, 0);
+        lua_setfield(L, -2, "vertices");
+
+        lua_createtable(L, batch.ranges.size(), 0);
+        for(size_t r=0; r<batch.ranges.size(); ++r)
+        {
+            const BatchRange &range = batch.ranges[r];
+            lua_createtable(L, 0, 5);
+            lua_pushnumber(L, range.node);
+            lua_setfield(L, -2, "node");
+            lua_pushnumber(L, range.mesh);
+            lua_setfield(L, -2, "mesh");
+            lua_pushnumber(L, range.primitive);
+            lua_setfield(L, -2, "primitive");
+            lua_pushnumber(L, range.firstindex);
+            lua_setfield(L, -2, "first");
+            lua_pushnumber(L, range.indexcount);
+            lua_setfield(L, -2, "count");
+            lua_rawseti(L, -2, r + 1);
+        }
+        lua_setfield(L, -2, "ranges");
+
+        lua_rawseti(L, -2, b + 1);
+    }
+    return 1;
+}
+
+// Instance transform from a matrix4, a vector3 position or a table with any of
+//   position (vector3), rotation (quat) and scale (vector3 or number)
+static bool ToInstanceMatrix(lua_State *L, int idx, float *m)
+{
+    dmVMath::Matrix4 *mtx = dmScript::ToMatrix4(L, idx);
+    if(mtx)
+    {
+        for(int c=0; c<4; ++c)
+            for(int r=0; r<4; ++r)
+                m[c * 4 + r] = mtx->getElem(c, r);
+        return true;
+    }
+
+    float t[3] = { 0.0f, 0.0f, 0.0f };
+    float q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    float s[3] = { 1.0f, 1.0f, 1.0f };
+    dmVMath::Vector3 *pos = dmScript::ToVector3(L, idx);
+    if(pos)
+    {
+        t[0] = pos->getX(); t[1] = pos->getY(); t[2] = pos->getZ();
+    }
+    else if(lua_istable(L, idx))
+    {
+        lua_getfield(L, idx, "position");
+        pos = dmScript::ToVector3(L, -1);
+        if(pos) { t[0] = pos->getX(); t[1] = pos->getY(); t[2] = pos->getZ(); }
+        lua_pop(L, 1);
+
+        lua_getfield(L, idx, "rotation");
+        dmVMath::Quat *rot = dmScript::ToQuat(L, -1);
+        if(rot) { q[0] = rot->getX(); q[1] = rot->getY(); q[2] = rot->getZ(); q[3] = rot->getW(); }
+        lua_pop(L, 1);
+
+        lua_getfield(L, idx, "scale");
+        dmVMath::Vector3 *scl = dmScript::ToVector3(L, -1);
+        if(scl) { s[0] = scl->getX(); s[1] = scl->getY(); s[2] = scl->getZ(); }
+        else if(lua_isnumber(L, -1)) s[0] = s[1] = s[2] = lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+    else
+        return false;
+
+    ComposeMatrix(t, q, s, m);
+    return true;
+}
+
+static bool ToInstanceColor(lua_State *L, int idx, float *c)
+{
+    dmVMath::Vector4 *color = dmScript::ToVector4(L, idx);
+    if(!color) return false;
+    c[0] = color->getX(); c[1] = color->getY(); c[2] = color->getZ(); c[3] = color->getW();
+    return true;
+}
+
+// Instance sets hold packed world matrices and colors for one mesh drawn many times
+static int InstancesCreate(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_create");
+    DM_LUA_STACK_CHECK(L, 1);
+    int capacity = (lua_gettop(L) > 0) ? luaL_checknumber(L, 1) : 64;
+    lua_pushnumber(L, CreateInstanceSet(capacity > 0 ? capacity : 1));
+    return 1;
+}
+
+static int InstancesDestroy(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_destroy");
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, DestroyInstanceSet(luaL_checknumber(L, 1)));
+    return 1;
+}
+
+// set, transform [, color] -> instance id
+static int InstancesAdd(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_add");
+    DM_LUA_STACK_CHECK(L, 1);
+    int set = luaL_checknumber(L, 1);
+    float m[INSTANCE_MATRIX_FLOATS], c[INSTANCE_COLOR_FLOATS];
+    if(!ToInstanceMatrix(L, 2, m))
+        return DM_LUA_ERROR("Expected a matrix4, vector3 or transform table");
+    bool hascolor = ToInstanceColor(L, 3, c);
+
+    int id = AddInstance(set, m, hascolor ? c : 0);
+    if(id < 0)
+        return DM_LUA_ERROR("Invalid instance set: %d", set);
+    lua_pushnumber(L, id);
+    return 1;
+}
+
+// set, id, transform|nil [, color]
+static int InstancesSet(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_set");
+    DM_LUA_STACK_CHECK(L, 1);
+    int set = luaL_checknumber(L, 1);
+    int id = luaL_checknumber(L, 2);
+    float m[INSTANCE_MATRIX_FLOATS], c[INSTANCE_COLOR_FLOATS];
+    bool hasmatrix = ToInstanceMatrix(L, 3, m);
+    bool hascolor = ToInstanceColor(L, 4, c);
+    lua_pushboolean(L, SetInstance(set, id, hasmatrix ? m : 0, hascolor ? c : 0));
+    return 1;
+}
+
+static int InstancesRemove(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_remove");
+    DM_LUA_STACK_CHECK(L, 1);
+    int set = luaL_checknumber(L, 1);
+    int id = luaL_checknumber(L, 2);
+    lua_pushboolean(L, RemoveInstance(set, id));
+    return 1;
+}
+
+// Replaces all instances. Each entry is a transform or { transform = , color = }.
+//   Returns the instance ids in array order.
+static int InstancesFill(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_fill");
+    DM_LUA_STACK_CHECK(L, 1);
+    int set = luaL_checknumber(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    if(!IsInstanceSet(set))
+        return DM_LUA_ERROR("Invalid instance set: %d", set);
+
+    ClearInstances(set);
+    int count = lua_objlen(L, 2);
+    lua_createtable(L, count, 0);
+    for(int i=0; i<count; ++i)
+    {
+        lua_rawgeti(L, 2, i + 1);
+        int entry = lua_gettop(L);
+        float m[INSTANCE_MATRIX_FLOATS], c[INSTANCE_COLOR_FLOATS];
+        bool hasmatrix = false, hascolor = false;
+
+        lua_getfield(L, entry, "transform");
+        if(!lua_isnil(L, -1))
+        {
+            hasmatrix = ToInstanceMatrix(L, -1, m);
+            lua_getfield(L, entry, "color");
+            hascolor = ToInstanceColor(L, -1, c);
+            lua_pop(L, 1);
+        }
+        else
+            hasmatrix = ToInstanceMatrix(L, entry, m);
+        lua_pop(L, 2);
+
+        lua_pushnumber(L, AddInstance(set, hasmatrix ? m : 0, hascolor ? c : 0));
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+// set -> buffer (mtx_world, color streams), live instance count
+static int InstancesBuffer(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_buffer");
+    DM_LUA_STACK_CHECK(L, 2);
+    int set = luaL_checknumber(L, 1);
+    uint32_t count = 0;
+    dmBuffer::HBuffer buffer = GetInstanceBuffer(set, &count);
+    if(buffer == 0)
+        return DM_LUA_ERROR("Invalid instance set: %d", set);
+
+    dmScript::LuaHBuffer luabuffer(buffer, dmScript::OWNER_C);
+    dmScript::PushBuffer(L, luabuffer);
+    lua_pushnumber(L, count);
+    return 2;
+}
+
+// set, function(self, set, count) called every update, or nil to stop
+static int InstancesSetCallback(lua_State *L)
+{
+    DM_PROFILE("gltfloader.instances_set_callback");
+    DM_LUA_STACK_CHECK(L, 1);
+    int set = luaL_checknumber(L, 1);
+    dmScript::LuaCallbackInfo *callback = 0;
+    if(lua_isfunction(L, 2))
+        callback = dmScript::CreateCallback(L, 2);
+
+    bool ok = SetInstanceCallback(set, callback);
+    if(!ok && callback) dmScript::DestroyCallback(callback);
+    lua_pushboolean(L, ok);
+    return 1;
+}
+
+// Spawns a mesh game object from the pool: [position [, rotation [, scale]]] -> id
+//   Pooled meshes go back with despawn_mesh, not go.delete.
+static int SpawnMesh(lua_State *L)
+{
+    DM_PROFILE("gltfloader.spawn_mesh");
+    DM_LUA_STACK_CHECK(L, 1);
+    int top = lua_gettop(L);
+    dmVMath::Point3 position(0.0f, 0.0f, 0.0f);
+    dmVMath::Quat rotation(0.0f, 0.0f, 0.0f, 1.0f);
+    dmVMath::Vector3 scale(1.0f, 1.0f, 1.0f);
+    if(top > 0 && !lua_isnil(L, 1)) position = dmVMath::Point3(*dmScript::CheckVector3(L, 1));
+    if(top > 1 && !lua_isnil(L, 2)) rotation = *dmScript::CheckQuat(L, 2);
+    if(top > 2 && !lua_isnil(L, 3))
+    {
+        if(lua_isnumber(L, 3))
+        {
+            float s = lua_tonumber(L, 3);
+            scale = dmVMath::Vector3(s, s, s);
+        }
+        else
+            scale = *dmScript::CheckVector3(L, 3);
+    }
+
+    dmGameObject::HInstance instance = SpawnPooledMesh(position, rotation, scale);
+    if(instance == 0)
+        lua_pushnil(L);
+    else
+        dmScript::PushHash(L, dmGameObject::GetIdentifier(instance));
+    return 1;
+}
+
+static int DespawnMesh(lua_State *L)
+{
+    DM_PROFILE("gltfloader.despawn_mesh");
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, DespawnPooledMesh(dmScript::CheckHashOrString(L, 1)));
+    return 1;
+}
+
+// count -> parked instances ready for spawning
+static int MeshPoolPrewarm(lua_State *L)
+{
+    DM_PROFILE("gltfloader.mesh_pool_prewarm");
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushnumber(L, PrewarmMeshPool(luaL_checknumber(L, 1)));
+    return 1;
+}
+
+// Float32 stream of a transforms buffer, 0 if missing or of another type
+static float *GetTransformStream(dmBuffer::HBuffer buffer, const char *name, uint32_t *components, uint32_t *stride)
+{
+    float* bytes = 0x0;
+    uint32_t count = 0;
+    dmBuffer::ValueType valuetype;
+    dmhash_t streamname = dmHashString64(name);
+    if(dmBuffer::GetStreamType(buffer, streamname, &valuetype, components) != dmBuffer::RESULT_OK)
+        return 0;
+    if(valuetype != dmBuffer::VALUE_TYPE_FLOAT32)
+    {
+        dmLogWarning("Stream '%s' is not float32, skipping it", name);
+        return 0;
+    }
+    if(dmBuffer::GetStream(buffer, streamname, (void**)&bytes, &count, components, stride) != dmBuffer::RESULT_OK)
+        return 0;
+    return bytes;
+}
+
+// Spawns one pooled mesh per element of transforms_buffer (position vec3, optional
+//   rotation quat and scale vec3 or float streams) spread over the next frames.
+//   vertices is the buffer resource holding the mesh (e.g. build_mesh +
+//   resource.create_buffer), set on the mesh component of every instance.
+//   There is no model_id/mesh argument on purpose: the extension never creates
+//   buffer resources itself (scripts do, with resource.create_buffer), so it has
+//   no model + mesh -> resource mapping to pick the vertices from. The script
+//   passes the resource it made for that mesh, the same as spawn_scene's meshes.
+//   transforms_buffer [, vertices [, callback(self, job, ids)]] -> job
+static int SpawnMany(lua_State *L)
+{
+    DM_PROFILE("gltfloader.spawn_many");
+    DM_LUA_STACK_CHECK(L, 1);
+    dmScript::LuaHBuffer *buffer = dmScript::CheckBuffer(L, 1);
+    int top = lua_gettop(L);
+    dmhash_t vertices = (top > 1 && !lua_isnil(L, 2)) ? dmScript::CheckHashOrString(L, 2) : 0;
+
+    uint32_t pcomps = 0, pstride = 0, rcomps = 0, rstride = 0, scomps = 0, sstride = 0;
+    const float *positions = GetTransformStream(buffer->m_Buffer, "position", &pcomps, &pstride);
+    const float *rotations = GetTransformStream(buffer->m_Buffer, "rotation", &rcomps, &rstride);
+    const float *scales = GetTransformStream(buffer->m_Buffer, "scale", &scomps, &sstride);
+    if(positions == 0 || pcomps < 3)
+        return DM_LUA_ERROR("Transforms buffer needs a float32 'position' stream with 3 components");
+    if(rotations && rcomps < 4) rotations = 0;
+
+    uint32_t count = 0;
+    dmBuffer::GetCount(buffer->m_Buffer, &count);
+
+    std::vector<SpawnTransform> transforms(count);
+    for(uint32_t i=0; i<count; ++i)
+    {
+        SpawnTransform &t = transforms[i];
+        memcpy(t.position, positions + i * pstride, sizeof(t.position));
+        if(rotations)
+            memcpy(t.rotation, rotations + i * rstride, sizeof(t.rotation));
+        else
+        {
+            t.rotation[0] = t.rotation[1] = t.rotation[2] = 0.0f;
+            t.rotation[3] = 1.0f;
+        }
+        if(scales && scomps >= 3)
+            memcpy(t.scale, scales + i * sstride, sizeof(t.scale));
+        else
+            t.scale[0] = t.scale[1] = t.scale[2] = scales ? scales[i * sstride] : 1.0f;
+    }
+
+    dmScript::LuaCallbackInfo *callback = 0;
+    if(top > 2 && lua_isfunction(L, 3))
+        callback = dmScript::CreateCallback(L, 3);
+
+    lua_pushnumber(L, QueueSpawnBatch(transforms, vertices, callback));
+    return 1;
+}
+
+// Instantiates every mesh node of a scene as pooled meshes over the next frames,
+//   parents first, with the node world transforms. meshes is a list of buffer
+//   resources for the vertices, meshes[i + 1] for glTF mesh i (1 based like every
+//   other table here). Progress goes to the callback, ids[n + 1] is the id spawned
+//   for glTF node n.
+//   model_id [, scene [, meshes [, callback(self, job, { done, total, finished, ids })]]] -> job
+static int SpawnScene(lua_State *L)
+{
+    DM_PROFILE("gltfloader.spawn_scene");
+    DM_LUA_STACK_CHECK(L, 1);
+    int modelid = luaL_checknumber(L, 1);
+    int top = lua_gettop(L);
+    int scene = (top > 1 && !lua_isnil(L, 2)) ? luaL_checknumber(L, 2) : -1;
+
+    tinygltf::Model *model = GetModel(modelid);
+    if(model == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+    if(scene >= (int)model->scenes.size())
+        return DM_LUA_ERROR("Invalid scene index: %d", scene);
+
+    std::vector<dmhash_t> meshvertices(model->meshes.size(), 0);
+    if(top > 2 && lua_istable(L, 3))
+    {
+        for(size_t m=0; m<meshvertices.size(); ++m)
+        {
+            lua_rawgeti(L, 3, (int)m + 1);
+            if(!lua_isnil(L, -1)) meshvertices[m] = dmScript::CheckHashOrString(L, -1);
+            lua_pop(L, 1);
+        }
+    }
+
+    std::vector<float> world;
+    std::vector<int> order;
+    ComputeWorldMatrices(*model, scene, world, &order);
+
+    std::vector<SpawnTransform> transforms;
+    std::vector<int> nodes;
+    std::vector<dmhash_t> vertices;
+    for(size_t i=0; i<order.size(); ++i)
+    {
+        int node = order[i];
+        int mesh = model->nodes[node].mesh;
+        if(mesh < 0 || mesh >= (int)model->meshes.size()) continue;
+
+        SpawnTransform t;
+        DecomposeMatrix(&world[node * 16], t.position, t.rotation, t.scale);
+        transforms.push_back(t);
+        nodes.push_back(node);
+        vertices.push_back(meshvertices[mesh]);
+    }
+
+    dmScript::LuaCallbackInfo *callback = 0;
+    if(top > 3 && lua_isfunction(L, 4))
+        callback = dmScript::CreateCallback(L, 4);
+
+    lua_pushnumber(L, QueueSpawnScene(transforms, nodes, vertices, callback));
+    return 1;
+}
+
+// Poses every node of the model at time (clamped to the clip): node i goes to
+//   element i of the position, rotation and scale float32 streams of out_buffer,
+//   the layout spawn_many reads. rotation and scale are optional. Nodes the clip
+//   does not animate get their rest pose. anim is an index or a name. cursors is
+//   an optional table per character (e.g. self.cursors = {}) that keeps its key
+//   positions between calls, without it every key is found by binary search.
+//   model_id, anim, time, out_buffer [, cursors] -> duration
+static int SampleAnimationPose(lua_State *L)
+{
+    DM_PROFILE("gltfloader.sample_animation");
+    DM_LUA_STACK_CHECK(L, 1);
+    int modelid = luaL_checknumber(L, 1);
+    float time = luaL_checknumber(L, 3);
+    dmScript::LuaHBuffer *buffer = dmScript::CheckBuffer(L, 4);
+
+    DefoldModel *dmodel = GetDefoldModel(modelid);
+    if(dmodel == 0)
+        return DM_LUA_ERROR("Invalid model id: %d", modelid);
+
+    int anim = -1;
+    if(lua_type(L, 2) == LUA_TSTRING)
+    {
+        const char *name = lua_tostring(L, 2);
+        for(size_t a=0; a<dmodel->model.animations.size() && anim < 0; ++a)
+            if(dmodel->model.animations[a].name == name) anim = (int)a;
+        if(anim < 0)
+            return DM_LUA_ERROR("Unknown animation: %s", name);
+    }
+    else
+    {
+        anim = luaL_checknumber(L, 2);
+        if(anim < 0 || anim >= (int)dmodel->animations.size())
+            return DM_LUA_ERROR("Invalid animation index: %d", anim);
+    }
+
+    uint32_t pcomps = 0, pstride = 0, rcomps = 0, rstride = 0, scomps = 0, sstride = 0;
+    float *positions = GetTransformStream(buffer->m_Buffer, "position", &pcomps, &pstride);
+    float *rotations = GetTransformStream(buffer->m_Buffer, "rotation", &rcomps, &rstride);
+    float *scales = GetTransformStream(buffer->m_Buffer, "scale", &scomps, &sstride);
+    if(positions == 0 || pcomps < 3)
+        return DM_LUA_ERROR("Pose buffer needs a float32 'position' stream with 3 components");
+    if(rotations && rcomps < 4) rotations = 0;
+    if(scales && scomps < 3) scales = 0;
+
+    uint32_t count = 0;
+    dmBuffer::GetCount(buffer->m_Buffer, &count);
+    size_t nodes = dmodel->restpose.size() / ANIMATION_TRS_FLOATS;
+    if(count < nodes)
+        return DM_LUA_ERROR("Pose buffer has %u elements, the model has %u nodes", count, (uint32_t)nodes);
+
+    // Kept between calls, one per character per frame should not allocate
+    static std::vector<float> pose;
+    pose.assign(dmodel->restpose.begin(), dmodel->restpose.end());
+    const AnimationClip &clip = dmodel->animations[anim];
+
+    // The clip is shared by every character, their cursors live in the table they pass
+    bool hascursors = lua_gettop(L) > 4 && lua_istable(L, 5);
+    static std::vector<size_t> cursors;
+    if(hascursors)
+    {
+        cursors.assign(clip.tracks.size(), 0);
+        for(size_t i=0; i<cursors.size(); ++i)
+        {
+            lua_rawgeti(L, 5, (int)i + 1);
+            lua_Number key = lua_isnumber(L, -1) ? lua_tonumber(L, -1) : 0;
+            if(key > 0 && key < clip.tracks[i].times.size()) cursors[i] = (size_t)key;
+            lua_pop(L, 1);
+        }
+    }
+    SampleAnimation(clip, time, pose.data(), nodes, hascursors ? cursors.data() : 0);
+    if(hascursors)
+    {
+        for(size_t i=0; i<cursors.size(); ++i)
+        {
+            lua_pushnumber(L, (lua_Number)cursors[i]);
+            lua_rawseti(L, 5, (int)i + 1);
+        }
+    }
+
+    for(size_t n=0; n<nodes; ++n)
+    {
+        const float *trs = &pose[n * ANIMATION_TRS_FLOATS];
+        memcpy(positions + n * pstride, trs + ANIMATION_TRANSLATION, 3 * sizeof(float));
+        if(rotations)
+            memcpy(rotations + n * rstride, trs + ANIMATION_ROTATION, 4 * sizeof(float));
+        if(scales)
+            memcpy(scales + n * sstride, trs + ANIMATION_SCALE, 3 * sizeof(float));
+    }
+    dmBuffer::ValidateBuffer(buffer->m_Buffer);
+
+    lua_pushnumber(L, clip.duration);
+    return 1;
+}
+
+// job -> done, total (nil when the job has finished or was cancelled)
+static int SpawnProgress(lua_State *L)
+{
+    DM_PROFILE("gltfloader.spawn_progress");
+    DM_LUA_STACK_CHECK(L, 2);
+    uint32_t done = 0, total = 0;
+    if(!GetSpawnJobProgress(luaL_checknumber(L, 1), &done, &total))
+    {
+        lua_pushnil(L);
+        lua_pushnil(L);
+        return 2;
+    }
+    lua_pushnumber(L, done);
+    lua_pushnumber(L, total);
+    return 2;
+}
+
+static int SpawnCancel(lua_State *L)
+{
+    DM_PROFILE("gltfloader.spawn_cancel");
+    DM_LUA_STACK_CHECK(L, 1);
+    lua_pushboolean(L, CancelSpawnJob(luaL_checknumber(L, 1)));
+    return 1;
+}
+
+// Milliseconds per update spent on queued spawns (gltfloader.spawn_budget_ms)
+static int SpawnSetBudget(lua_State *L)
+{
+    DM_PROFILE("gltfloader.set_spawn_budget");
+    DM_LUA_STACK_CHECK(L, 0);
+    SetSpawnBudget(luaL_checknumber(L, 1));
+    return 0;
+}
+
+// Track a game object for distance based lod switching.
+//   id, mesh component, { lod0, lod1 ... } buffer resource hashes, { distance0, ... } [, hysteresis]
+static int LodAdd(lua_State *L)
+{
+    DM_PROFILE("gltfloader.lod_add");
+    DM_LUA_STACK_CHECK(L, 1);
+    dmhash_t id = dmScript::CheckHashOrString(L, 1);
+    dmhash_t component = dmScript::CheckHashOrString(L, 2);
+    luaL_checktype(L, 3, LUA_TTABLE);
+    luaL_checktype(L, 4, LUA_TTABLE);
+    float hysteresis = (lua_gettop(L) > 4) ? luaL_checknumber(L, 5) : 0.1f;
+
+    if(!(hysteresis >= 0.0f && hysteresis < 1.0f))
+        return DM_LUA_ERROR("Hysteresis must be in [0, 1), got %f", hysteresis);
+
+    int numlevels = lua_objlen(L, 3);
+    if(numlevels < 1 || numlevels > LOD_MAX_LEVELS)
+        return DM_LUA_ERROR("Between 1 and %d lod levels are supported", LOD_MAX_LEVELS);
+    if((int)lua_objlen(L, 4) < numlevels - 1)
+        return DM_LUA_ERROR("Need %d distances for %d lod levels", numlevels - 1, numlevels);
+
+    dmhash_t levels[LOD_MAX_LEVELS];
+    float distances[LOD_MAX_LEVELS];
+    for(int i=0; i<numlevels; ++i)
+    {
+        lua_rawgeti(L, 3, i + 1);
+        levels[i] = dmScript::CheckHashOrString(L, -1);
+        lua_pop(L, 1);
+        if(i < numlevels - 1)
+        {
+            lua_rawgeti(L, 4, i + 1);
+            distances[i] = lua_tonumber(L, -1);
+            lua_pop(L, 1);
+            if(!(distances[i] > (i > 0 ? distances[i - 1] : 0.0f)))
+                return DM_LUA_ERROR("Lod distances must be positive and strictly increasing, distance %d is %f", i + 1, distances[i]);
+        }
+    }
+
+    lua_pushboolean(L, AddLodInstance(id, component, levels, distances, numlevels, hysteresis));
+    return 1;
+}
+
+static int LodRemove(lua_State *L)
+{
+    DM_PROFILE("gltfloader.lod_remove");
+    DM_LUA_STACK_CHECK(L, 1);
+    dmhash_t id = dmScript::CheckHashOrString(L, 1);
+    lua_pushboolean(L, RemoveLodInstance(id));
+    return 1;
+}
+
+// Either a vector3 position or the id of a game object to follow (the camera)
+static int LodSetCamera(lua_State *L)
+{
+    DM_PROFILE("gltfloader.lod_set_camera");
+    DM_LUA_STACK_CHECK(L, 0);
+    dmVMath::Vector3 *pos = dmScript::ToVector3(L, 1);
+    if(pos)
+        SetLodCameraPosition(dmVMath::Point3(*pos));
+    else
+        SetLodCameraInstance(dmScript::CheckHashOrString(L, 1));
+    return 0;
+}
+
 // Functions exposed to Lua
 static const luaL_reg Module_methods[] =
 {
@@ -313,6 +1445,38 @@ static const luaL_reg Module_methods[] =
     {"updateobb", UpdateOBB},
 
     {"loadgltf", LoadGltf},
+    {"get_image", GetImage},
+    {"get_bounds", GetBounds},
+    {"stats", Stats},
+    {"model_stats", ModelStats},
+    {"describe", Describe},
+    {"unindex", Unindex},
+    {"build_mesh", BuildMesh},
+    {"build_lods", BuildLods},
+    {"build_static_batch", BuildStaticBatch},
+
+    {"lod_add", LodAdd},
+    {"lod_remove", LodRemove},
+    {"lod_set_camera", LodSetCamera},
+
+    {"spawn_mesh", SpawnMesh},
+    {"despawn_mesh", DespawnMesh},
+    {"mesh_pool_prewarm", MeshPoolPrewarm},
+    {"spawn_many", SpawnMany},
+    {"spawn_scene", SpawnScene},
+    {"sample_animation", SampleAnimationPose},
+    {"spawn_progress", SpawnProgress},
+    {"spawn_cancel", SpawnCancel},
+    {"set_spawn_budget", SpawnSetBudget},
+
+    {"instances_create", InstancesCreate},
+    {"instances_destroy", InstancesDestroy},
+    {"instances_add", InstancesAdd},
+    {"instances_set", InstancesSet},
+    {"instances_remove", InstancesRemove},
+    {"instances_fill", InstancesFill},
+    {"instances_buffer", InstancesBuffer},
+    {"instances_set_callback", InstancesSetCallback},
 
     {"perlinnoise", PerlinNoise},    
     {0, 0}
@@ -325,6 +1489,14 @@ static void LuaInit(lua_State* L)
     // Register lua names
     luaL_register(L, MODULE_NAME, Module_methods);
 
+    #define SETCONSTANT(name) \
+        lua_pushnumber(L, (lua_Number) name); \
+        lua_setfield(L, -2, #name);\
+
+        SETCONSTANT(LOAD_LAZY_IMAGES)
+        SETCONSTANT(LOAD_NO_CACHE)
+    #undef SETCONSTANT
+
     lua_pop(L, 1);
     assert(top == lua_gettop(L));
 }
@@ -346,18 +1518,29 @@ dmExtension::Result Initializegltfloader(dmExtension::Params* params)
 dmExtension::Result AppFinalizegltfloader(dmExtension::AppParams* params)
 {
     dmLogInfo("AppFinalizegltfloader\n");
+    ShutdownJobs();
     return dmExtension::RESULT_OK;
 }
 
 dmExtension::Result Finalizegltfloader(dmExtension::Params* params)
 {
     dmLogInfo("Finalizegltfloader\n");
+    ClearLodInstances();
+    ClearInstanceSets();
+    ClearSpawnQueue();
     return dmExtension::RESULT_OK;
 }
 
 dmExtension::Result OnUpdategltfloader(dmExtension::Params* params)
 {
     // dmLogInfo("OnUpdategltfloader\n");
+    DM_PROFILE("gltfloader.update");
+    UpdateLods(GetMainCollection());
+    UpdateInstanceSets();
+    UpdateSpawnQueue();
+
+    // Conversions run from script calls and job threads, they are summed up here once a frame
+    DM_PROPERTY_ADD_U32(rmtp_GltfBytesConverted, (uint32_t)TakeConvertedBytes());
     return dmExtension::RESULT_OK;
 }
 
@@ -379,6 +1562,7 @@ void OnEventgltfloader(dmExtension::Params* params, const dmExtension::Event* ev
             break;
         case dmExtension::EVENT_ID_ENGINE_INITIALIZED:
             InitMeshBuilding(params->m_ResourceFactory, params->m_ConfigFile);
+            InitSpawnQueue(params->m_ConfigFile);
             break;
         case dmExtension::EVENT_ID_ENGINE_DELETE:
             DestroyMeshBuilding();
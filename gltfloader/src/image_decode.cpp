@@ -0,0 +1,77 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "image_decode.h"
+#include "jobs.h"
+#include "gltf_profile.h"
+
+bool StageImageData( tinygltf::Image *image, const int, std::string *,
+                     std::string *, int req_width, int req_height,
+                     const unsigned char *bytes, int size, void * )
+{
+    // Width and height from the json (if any) are kept and checked on decode
+    image->width = req_width;
+    image->height = req_height;
+    image->as_is = true;
+    image->image.assign(bytes, bytes + size);
+    return true;
+}
+
+bool DecodeImage( tinygltf::Image &image, int image_idx, std::string *err )
+{
+    GLTF_PROFILE("GltfDecodeImage");
+    if(!image.as_is || image.image.empty()) return true;
+
+    // The decoder writes its pixels back into image.image, so move the source out first
+    std::vector<unsigned char> encoded;
+    encoded.swap(image.image);
+
+    std::string warn;
+    int req_width = (image.width > 0) ? image.width : 0;
+    int req_height = (image.height > 0) ? image.height : 0;
+    bool ok = tinygltf::LoadImageData(&image, image_idx, err, &warn, req_width, req_height,
+                                      &encoded[0], (int)encoded.size(), 0);
+    if(!ok)
+    {
+        // Leave the encoded data in place so the image can be inspected/retried
+        image.image.swap(encoded);
+        return false;
+    }
+    return true;
+}
+
+typedef struct DecodeContext
+{
+    tinygltf::Model             *model;
+    std::vector<std::string>    errors;
+    std::vector<char>           results;
+} DecodeContext;
+
+static void DecodeImageJob( void *ctx, uint32_t index )
+{
+    DecodeContext *decode = (DecodeContext *)ctx;
+    decode->results[index] = DecodeImage(decode->model->images[index], index, &decode->errors[index]) ? 1 : 0;
+}
+
+bool DecodeImages( tinygltf::Model &model, std::string *err )
+{
+    GLTF_PROFILE("GltfDecodeImages");
+    DecodeContext ctx;
+    ctx.model = &model;
+    ctx.errors.resize(model.images.size());
+    ctx.results.resize(model.images.size(), 1);
+
+    ParallelFor((uint32_t)model.images.size(), DecodeImageJob, &ctx);
+
+    // Errors are collected per image so the workers never share a string
+    bool ok = true;
+    for(size_t i=0; i<ctx.results.size(); ++i)
+    {
+        if(err) (*err) += ctx.errors[i];
+        if(!ctx.results[i]) ok = false;
+    }
+    return ok;
+}
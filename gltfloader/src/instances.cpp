@@ -0,0 +1,303 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#include "instances.h"
+
+typedef struct InstanceSet {
+    bool                        used;
+    std::vector<float>          matrices;       // INSTANCE_MATRIX_FLOATS per slot, packed
+    std::vector<float>          colors;         // INSTANCE_COLOR_FLOATS per slot, packed
+    std::vector<int>            slotids;        // slot -> instance id
+    std::vector<int>            idslots;        // instance id -> slot, -1 when free
+    std::vector<int>            freeids;
+    uint32_t                    count;
+    dmBuffer::HBuffer           buffer;
+    uint32_t                    buffercapacity;
+    uint32_t                    dirtymin;       // Slots [dirtymin, dirtymax) need an upload
+    uint32_t                    dirtymax;
+    dmScript::LuaCallbackInfo   *callback;
+} InstanceSet;
+
+static std::vector<InstanceSet>     g_sets;
+static int                          g_invoking = -1;    // Set whose callback is running
+
+static const dmhash_t               MATRIX_STREAM = dmHashString64("mtx_world");
+static const dmhash_t               COLOR_STREAM = dmHashString64("color");
+
+static const float IDENTITY[INSTANCE_MATRIX_FLOATS] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+static const float WHITE[INSTANCE_COLOR_FLOATS] = { 1,1,1,1 };
+
+static InstanceSet *GetSet( int set )
+{
+    if( set < 0 || set >= (int)g_sets.size() || !g_sets[set].used ) return 0;
+    return &g_sets[set];
+}
+
+static void MarkDirty( InstanceSet *s, uint32_t slot )
+{
+    if( slot < s->dirtymin ) s->dirtymin = slot;
+    if( slot + 1 > s->dirtymax ) s->dirtymax = slot + 1;
+}
+
+int CreateInstanceSet( uint32_t capacity )
+{
+    size_t index = 0;
+    while( index < g_sets.size() && g_sets[index].used ) ++index;
+    if( index == g_sets.size() ) g_sets.push_back(InstanceSet());
+
+    InstanceSet &s = g_sets[index];
+    s.used = true;
+    s.matrices.clear();
+    s.colors.clear();
+    s.slotids.clear();
+    s.idslots.clear();
+    s.freeids.clear();
+    s.matrices.reserve(capacity * INSTANCE_MATRIX_FLOATS);
+    s.colors.reserve(capacity * INSTANCE_COLOR_FLOATS);
+    s.slotids.reserve(capacity);
+    s.idslots.reserve(capacity);
+    s.count = 0;
+    s.buffer = 0;
+    s.buffercapacity = capacity;
+    s.dirtymin = 0xffffffff;
+    s.dirtymax = 0;
+    s.callback = 0;
+    return (int)index;
+}
+
+bool DestroyInstanceSet( int set )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s ) return false;
+    if( s->buffer ) dmBuffer::Destroy(s->buffer);
+    if( s->callback && set != g_invoking ) dmScript::DestroyCallback(s->callback);
+    s->buffer = 0;
+    s->callback = 0;
+    s->used = false;
+    std::vector<float>().swap(s->matrices);
+    std::vector<float>().swap(s->colors);
+    std::vector<int>().swap(s->slotids);
+    std::vector<int>().swap(s->idslots);
+    std::vector<int>().swap(s->freeids);
+    return true;
+}
+
+bool IsInstanceSet( int set )
+{
+    return GetSet(set) != 0;
+}
+
+void ClearInstanceSets()
+{
+    for( size_t i=0; i<g_sets.size(); ++i )
+        DestroyInstanceSet((int)i);
+    g_sets.clear();
+}
+
+int AddInstance( int set, const float *matrix, const float *color )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s ) return -1;
+
+    int id;
+    if( !s->freeids.empty() )
+    {
+        id = s->freeids.back();
+        s->freeids.pop_back();
+    }
+    else
+    {
+        id = (int)s->idslots.size();
+        s->idslots.push_back(-1);
+    }
+
+    uint32_t slot = s->count++;
+    s->idslots[id] = (int)slot;
+    s->slotids.push_back(id);
+    s->matrices.insert(s->matrices.end(), matrix ? matrix : IDENTITY, (matrix ? matrix : IDENTITY) + INSTANCE_MATRIX_FLOATS);
+    s->colors.insert(s->colors.end(), color ? color : WHITE, (color ? color : WHITE) + INSTANCE_COLOR_FLOATS);
+    MarkDirty(s, slot);
+    return id;
+}
+
+bool SetInstance( int set, int id, const float *matrix, const float *color )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s || id < 0 || id >= (int)s->idslots.size() || s->idslots[id] < 0 ) return false;
+
+    uint32_t slot = (uint32_t)s->idslots[id];
+    if( matrix ) memcpy(&s->matrices[slot * INSTANCE_MATRIX_FLOATS], matrix, sizeof(float) * INSTANCE_MATRIX_FLOATS);
+    if( color ) memcpy(&s->colors[slot * INSTANCE_COLOR_FLOATS], color, sizeof(float) * INSTANCE_COLOR_FLOATS);
+    MarkDirty(s, slot);
+    return true;
+}
+
+bool RemoveInstance( int set, int id )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s || id < 0 || id >= (int)s->idslots.size() || s->idslots[id] < 0 ) return false;
+
+    // Swap and pop, the last instance fills the hole
+    uint32_t slot = (uint32_t)s->idslots[id];
+    uint32_t last = s->count - 1;
+    if( slot != last )
+    {
+        memcpy(&s->matrices[slot * INSTANCE_MATRIX_FLOATS], &s->matrices[last * INSTANCE_MATRIX_FLOATS], sizeof(float) * INSTANCE_MATRIX_FLOATS);
+        memcpy(&s->colors[slot * INSTANCE_COLOR_FLOATS], &s->colors[last * INSTANCE_COLOR_FLOATS], sizeof(float) * INSTANCE_COLOR_FLOATS);
+        int moved = s->slotids[last];
+        s->slotids[slot] = moved;
+        s->idslots[moved] = (int)slot;
+        MarkDirty(s, slot);
+    }
+    s->matrices.resize(last * INSTANCE_MATRIX_FLOATS);
+    s->colors.resize(last * INSTANCE_COLOR_FLOATS);
+    s->slotids.pop_back();
+    s->idslots[id] = -1;
+    s->freeids.push_back(id);
+    s->count = last;
+
+    // The freed slot gets a zero matrix on upload so drawing the whole buffer is safe
+    MarkDirty(s, last);
+    return true;
+}
+
+void ClearInstances( int set )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s ) return;
+    if( s->count > 0 ) MarkDirty(s, s->count - 1);
+    s->dirtymin = 0;
+    s->matrices.clear();
+    s->colors.clear();
+    s->slotids.clear();
+    s->idslots.clear();
+    s->freeids.clear();
+    s->count = 0;
+}
+
+uint32_t GetInstanceCount( int set )
+{
+    InstanceSet *s = GetSet(set);
+    return s ? s->count : 0;
+}
+
+static bool CreateBuffer( InstanceSet *s )
+{
+    uint32_t capacity = s->buffercapacity;
+    if( capacity < s->count ) capacity = s->count;
+    if( capacity < 1 ) capacity = 1;
+
+    dmBuffer::StreamDeclaration streams_decl[] = {
+        { MATRIX_STREAM, dmBuffer::VALUE_TYPE_FLOAT32, INSTANCE_MATRIX_FLOATS },
+        { COLOR_STREAM, dmBuffer::VALUE_TYPE_FLOAT32, INSTANCE_COLOR_FLOATS }
+    };
+
+    dmBuffer::HBuffer buffer;
+    if( dmBuffer::Create(capacity, streams_decl, 2, &buffer) != dmBuffer::RESULT_OK )
+        return false;
+
+    uint8_t* data = 0;
+    uint32_t datasize = 0;
+    dmBuffer::GetBytes(buffer, (void**)&data, &datasize);
+    memset(data, 0, datasize);
+
+    if( s->buffer ) dmBuffer::Destroy(s->buffer);
+    s->buffer = buffer;
+    s->buffercapacity = capacity;
+    s->dirtymin = 0;
+    s->dirtymax = capacity;
+    return true;
+}
+
+static void UploadSet( InstanceSet *s )
+{
+    DM_PROFILE("GltfInstanceUpload");
+    if( !s->buffer || s->count > s->buffercapacity )
+    {
+        // Grow by half again so bursts of adds do not recreate it every frame
+        uint32_t grown = s->buffercapacity + s->buffercapacity / 2;
+        if( s->buffer && grown > s->count ) s->buffercapacity = grown;
+        if( !CreateBuffer(s) ) return;
+    }
+    if( s->dirtymin >= s->dirtymax ) return;
+
+    float *matrices = 0, *colors = 0;
+    uint32_t count = 0, components = 0, mstride = 0, cstride = 0;
+    if( dmBuffer::GetStream(s->buffer, MATRIX_STREAM, (void**)&matrices, &count, &components, &mstride) != dmBuffer::RESULT_OK ) return;
+    if( dmBuffer::GetStream(s->buffer, COLOR_STREAM, (void**)&colors, &count, &components, &cstride) != dmBuffer::RESULT_OK ) return;
+
+    uint32_t end = s->dirtymax < count ? s->dirtymax : count;
+    for( uint32_t i=s->dirtymin; i<end; ++i )
+    {
+        float *m = matrices + i * mstride;
+        float *c = colors + i * cstride;
+        if( i < s->count )
+        {
+            memcpy(m, &s->matrices[i * INSTANCE_MATRIX_FLOATS], sizeof(float) * INSTANCE_MATRIX_FLOATS);
+            memcpy(c, &s->colors[i * INSTANCE_COLOR_FLOATS], sizeof(float) * INSTANCE_COLOR_FLOATS);
+        }
+        else
+        {
+            memset(m, 0, sizeof(float) * INSTANCE_MATRIX_FLOATS);
+            memset(c, 0, sizeof(float) * INSTANCE_COLOR_FLOATS);
+        }
+    }
+    dmBuffer::ValidateBuffer(s->buffer);
+    s->dirtymin = 0xffffffff;
+    s->dirtymax = 0;
+}
+
+dmBuffer::HBuffer GetInstanceBuffer( int set, uint32_t *count )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s ) return 0;
+    UploadSet(s);
+    if( count ) *count = s->count;
+    return s->buffer;
+}
+
+bool SetInstanceCallback( int set, dmScript::LuaCallbackInfo *callback )
+{
+    InstanceSet *s = GetSet(set);
+    if( !s ) return false;
+    if( s->callback && set != g_invoking ) dmScript::DestroyCallback(s->callback);
+    s->callback = callback;
+    return true;
+}
+
+static void InvokeCallback( int set )
+{
+    dmScript::LuaCallbackInfo *callback = g_sets[set].callback;
+    if( !dmScript::IsCallbackValid(callback) ) return;
+
+    lua_State* L = dmScript::GetCallbackLuaContext(callback);
+    DM_LUA_STACK_CHECK(L, 0);
+    if( !dmScript::SetupCallback(callback) ) return;
+
+    lua_pushnumber(L, set);
+    lua_pushnumber(L, g_sets[set].count);
+    g_invoking = set;
+    dmScript::PCall(L, 3, 0);       // self, set, count
+    g_invoking = -1;
+    dmScript::TeardownCallback(callback);
+
+    // The callback replaced itself or destroyed its set, free it now that it has returned
+    if( !g_sets[set].used || g_sets[set].callback != callback )
+        dmScript::DestroyCallback(callback);
+}
+
+void UpdateInstanceSets()
+{
+    DM_PROFILE("GltfInstanceSets");
+    // Index loop, a callback may create or destroy sets
+    for( size_t i=0; i<g_sets.size(); ++i )
+    {
+        if( g_sets[i].used && g_sets[i].callback ) InvokeCallback((int)i);
+        if( g_sets[i].used && g_sets[i].buffer ) UploadSet(&g_sets[i]);
+    }
+}
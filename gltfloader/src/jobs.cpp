@@ -0,0 +1,162 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "jobs.h"
+
+#if !defined(__EMSCRIPTEN__)
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#define JOBS_THREADED
+#endif
+
+#if defined(JOBS_THREADED)
+
+typedef struct JobBatch
+{
+    JobFunc                 func;
+    void                    *ctx;
+    uint32_t                count;
+    std::atomic<uint32_t>   next;
+    std::atomic<uint32_t>   done;
+    uint32_t                active;     // Workers inside the batch, guarded by g_lock
+} JobBatch;
+
+static std::vector<std::thread>     g_workers;
+static std::mutex                   g_lock;
+static std::condition_variable      g_wake;
+static std::condition_variable      g_finished;
+static JobBatch                     *g_batch = 0;
+static bool                         g_quit = false;
+static uint32_t                     g_threads = 0;      // 0 picks from the core count
+
+static void RunBatch( JobBatch *batch )
+{
+    uint32_t i;
+    while( (i = batch->next.fetch_add(1)) < batch->count )
+    {
+        batch->func(batch->ctx, i);
+        batch->done.fetch_add(1);
+    }
+}
+
+static void WorkerMain()
+{
+    std::unique_lock<std::mutex> lock(g_lock);
+    while(true)
+    {
+        g_wake.wait(lock, [] { return g_quit || (g_batch && g_batch->next.load() < g_batch->count); });
+        if(g_quit) return;
+
+        JobBatch *batch = g_batch;
+        batch->active++;
+        lock.unlock();
+        RunBatch(batch);
+        lock.lock();
+        batch->active--;
+        g_finished.notify_all();
+    }
+}
+
+static void StartWorkers()
+{
+    if(!g_workers.empty()) return;
+
+    // Keep one core for the caller, it works on the batch too
+    uint32_t cores = g_threads ? g_threads : std::thread::hardware_concurrency();
+    uint32_t count = (cores > 1) ? cores - 1 : 0;
+    g_quit = false;
+    for(uint32_t i=0; i<count; ++i)
+        g_workers.push_back(std::thread(WorkerMain));
+}
+
+void ParallelFor( uint32_t count, JobFunc func, void *ctx )
+{
+    if(count == 0) return;
+
+    StartWorkers();
+    JobBatch batch;
+    batch.func = func;
+    batch.ctx = ctx;
+    batch.count = count;
+    batch.next = 0;
+    batch.done = 0;
+    batch.active = 0;
+
+    // The pool runs one batch at a time. A call made while another batch runs (from
+    // another thread, or from inside a job) does its work on the calling thread.
+    bool shared = false;
+    if(count > 1 && !g_workers.empty())
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        if(g_batch == 0)
+        {
+            g_batch = &batch;
+            shared = true;
+        }
+    }
+    if(!shared)
+    {
+        for(uint32_t i=0; i<count; ++i)
+            func(ctx, i);
+        return;
+    }
+    g_wake.notify_all();
+
+    RunBatch(&batch);
+
+    std::unique_lock<std::mutex> lock(g_lock);
+    g_finished.wait(lock, [&batch] { return batch.done.load() == batch.count && batch.active == 0; });
+    g_batch = 0;
+}
+
+uint32_t GetJobThreadCount()
+{
+    StartWorkers();
+    return (uint32_t)g_workers.size() + 1;
+}
+
+void SetJobThreadCount( uint32_t threads )
+{
+    ShutdownJobs();
+    g_threads = threads;
+}
+
+void ShutdownJobs()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_lock);
+        g_quit = true;
+    }
+    g_wake.notify_all();
+    for(size_t i=0; i<g_workers.size(); ++i)
+        g_workers[i].join();
+    g_workers.clear();
+}
+
+#else
+
+// No threads available (html5), everything runs on the caller
+void ParallelFor( uint32_t count, JobFunc func, void *ctx )
+{
+    for(uint32_t i=0; i<count; ++i)
+        func(ctx, i);
+}
+
+uint32_t GetJobThreadCount()
+{
+    return 1;
+}
+
+void SetJobThreadCount( uint32_t )
+{
+}
+
+void ShutdownJobs()
+{
+}
+
+#endif
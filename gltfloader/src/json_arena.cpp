@@ -0,0 +1,92 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+
+#include "json_arena.h"
+
+#define JSON_ARENA_ALIGN        16
+#define JSON_ARENA_MIN_CHUNK    (256 * 1024)
+#define JSON_ARENA_MAX_CHUNK    (16 * 1024 * 1024)
+
+// Chunks are linked through their first bytes, the allocations follow
+typedef struct JsonArenaChunk {
+    JsonArenaChunk  *next;
+    size_t          size;
+} JsonArenaChunk;
+
+typedef struct JsonArena {
+    JsonArenaChunk  *chunks;
+    uint8_t         *cur;
+    uint8_t         *end;
+    size_t          used;
+    int             depth;
+} JsonArena;
+
+static thread_local JsonArena g_arena;
+
+static size_t AlignUp( size_t size )
+{
+    return (size + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1);
+}
+
+// Each chunk is as big as all the ones before it, so a large file needs few of them
+static void AddChunk( JsonArena &arena, size_t size )
+{
+    size_t chunksize = arena.chunks ? arena.chunks->size * 2 : JSON_ARENA_MIN_CHUNK;
+    if( chunksize > JSON_ARENA_MAX_CHUNK ) chunksize = JSON_ARENA_MAX_CHUNK;
+    size_t header = AlignUp(sizeof(JsonArenaChunk));
+    if( chunksize < header + size ) chunksize = header + size;
+
+    JsonArenaChunk *chunk = (JsonArenaChunk *)malloc(chunksize);
+    if( !chunk ) throw std::bad_alloc();
+    chunk->next = arena.chunks;
+    chunk->size = chunksize;
+    arena.chunks = chunk;
+    arena.cur = (uint8_t *)chunk + header;
+    arena.end = (uint8_t *)chunk + chunksize;
+}
+
+void BeginJsonArena()
+{
+    g_arena.depth++;
+}
+
+void EndJsonArena()
+{
+    JsonArena &arena = g_arena;
+    if( --arena.depth > 0 ) return;
+    while( arena.chunks )
+    {
+        JsonArenaChunk *next = arena.chunks->next;
+        free(arena.chunks);
+        arena.chunks = next;
+    }
+    arena.cur = arena.end = 0;
+    arena.used = 0;
+    arena.depth = 0;
+}
+
+size_t GetJsonArenaUsed()
+{
+    return g_arena.used;
+}
+
+void *JsonArenaAlloc( size_t size )
+{
+    JsonArena &arena = g_arena;
+    if( arena.depth <= 0 ) return ::operator new(size);
+
+    size = AlignUp(size ? size : 1);
+    if( (size_t)(arena.end - arena.cur) < size )
+        AddChunk(arena, size);
+    void *ptr = arena.cur;
+    arena.cur += size;
+    arena.used += size;
+    return ptr;
+}
+
+// Nothing is given back until EndJsonArena, the DOM is torn down right before it anyway
+void JsonArenaFree( void *ptr, size_t )
+{
+    if( g_arena.depth <= 0 ) ::operator delete(ptr);
+}
@@ -0,0 +1,149 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#include "lod_manager.h"
+
+typedef struct LodInstance {
+    dmhash_t        id;
+    dmhash_t        component;
+    dmhash_t        levels[LOD_MAX_LEVELS];
+    float           switchin[LOD_MAX_LEVELS];      // Squared distance to go up to level i+1
+    float           switchout[LOD_MAX_LEVELS];     // Squared distance to come back to level i
+    int             numlevels;
+    int             current;                        // -1 until the first update sets a level
+} LodInstance;
+
+static std::vector<LodInstance>     g_lods;
+static dmVMath::Point3              g_camerapos(0.0f, 0.0f, 0.0f);
+static dmhash_t                     g_cameraid = 0;
+
+static const dmhash_t               VERTICES_PROPERTY = dmHashString64("vertices");
+
+bool AddLodInstance( dmhash_t id, dmhash_t component, const dmhash_t *levels, const float *distances, int numlevels, float hysteresis )
+{
+    if( numlevels < 1 || numlevels > LOD_MAX_LEVELS )
+        return false;
+    // At 1 or more the switch out distance would go negative and flip the band
+    if( !(hysteresis >= 0.0f && hysteresis < 1.0f) )
+        return false;
+    // The bands assume ascending thresholds
+    for( int i=0; i<numlevels - 1; ++i )
+    {
+        if( !(distances[i] > (i > 0 ? distances[i - 1] : 0.0f)) )
+            return false;
+    }
+
+    RemoveLodInstance(id);
+
+    LodInstance lod;
+    memset(&lod, 0, sizeof(lod));
+    lod.id = id;
+    lod.component = component;
+    lod.numlevels = numlevels;
+    lod.current = -1;
+    for( int i=0; i<numlevels; ++i )
+    {
+        lod.levels[i] = levels[i];
+        if( i < numlevels - 1 )
+        {
+            // Distances are compared squared, saves the sqrt per instance
+            float in = distances[i] * (1.0f + hysteresis);
+            float out = distances[i] * (1.0f - hysteresis);
+            lod.switchin[i] = in * in;
+            lod.switchout[i] = out * out;
+        }
+    }
+    g_lods.push_back(lod);
+    return true;
+}
+
+bool RemoveLodInstance( dmhash_t id )
+{
+    for( size_t i=0; i<g_lods.size(); ++i )
+    {
+        if( g_lods[i].id == id )
+        {
+            g_lods[i] = g_lods.back();
+            g_lods.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ClearLodInstances()
+{
+    g_lods.clear();
+    g_cameraid = 0;
+}
+
+void SetLodCameraPosition( const dmVMath::Point3 &position )
+{
+    g_camerapos = position;
+    g_cameraid = 0;
+}
+
+void SetLodCameraInstance( dmhash_t id )
+{
+    g_cameraid = id;
+}
+
+void UpdateLods( dmGameObject::HCollection collection )
+{
+    DM_PROFILE("GltfLods");
+    if( g_lods.empty() || collection == 0 ) return;
+
+    if( g_cameraid )
+    {
+        dmGameObject::HInstance camera = dmGameObject::GetInstanceFromIdentifier(collection, g_cameraid);
+        if( camera ) g_camerapos = dmGameObject::GetWorldPosition(camera);
+    }
+    const float cx = g_camerapos.getX();
+    const float cy = g_camerapos.getY();
+    const float cz = g_camerapos.getZ();
+
+    size_t i = 0;
+    while( i < g_lods.size() )
+    {
+        LodInstance &lod = g_lods[i];
+
+        // Instances are looked up by id so deleted objects just drop out of the list
+        dmGameObject::HInstance instance = dmGameObject::GetInstanceFromIdentifier(collection, lod.id);
+        if( instance == 0 )
+        {
+            g_lods[i] = g_lods.back();
+            g_lods.pop_back();
+            continue;
+        }
+
+        dmVMath::Point3 pos = dmGameObject::GetWorldPosition(instance);
+        float dx = pos.getX() - cx;
+        float dy = pos.getY() - cy;
+        float dz = pos.getZ() - cz;
+        float dist2 = dx * dx + dy * dy + dz * dz;
+
+        int level = (lod.current < 0) ? 0 : lod.current;
+        while( level < lod.numlevels - 1 && dist2 > lod.switchin[level] )
+            level++;
+        while( level > 0 && dist2 < lod.switchout[level - 1] )
+            level--;
+
+        if( level != lod.current )
+        {
+            dmGameObject::PropertyOptions options;
+            dmGameObject::PropertyVar var(lod.levels[level]);
+            dmGameObject::PropertyResult r = dmGameObject::SetProperty(instance, lod.component, VERTICES_PROPERTY, options, var);
+            // A failed switch keeps the old level and is tried again next update
+            if( r == dmGameObject::PROPERTY_RESULT_OK )
+                lod.current = level;
+            else
+                dmLogWarning("Failed to set lod %d on '%s' (%d)", level, dmHashReverseSafe64(lod.id), r);
+        }
+        i++;
+    }
+}
@@ -0,0 +1,171 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "mesh.h"
+#include "accessor.h"
+#include "gltf_profile.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MESH_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define MESH_PREFETCH(addr)
+#endif
+
+// How many indices ahead the gather prefetches the source vertices
+#define GATHER_PREFETCH_DISTANCE   16
+
+const StreamAttribute g_StreamAttributes[] = {
+    { "position",   "POSITION" },
+    { "normal",     "NORMAL" },
+    { "tangent",    "TANGENT" },
+    { "texcoord0",  "TEXCOORD_0" },
+    { "texcoord1",  "TEXCOORD_1" },
+    { "color",      "COLOR_0" },
+    { 0, 0 }
+};
+
+size_t GetVertexCount( const tinygltf::Model &model, const tinygltf::Primitive &prim )
+{
+    std::map<std::string, int>::const_iterator it = prim.attributes.find("POSITION");
+    if( it == prim.attributes.end() || it->second < 0 || it->second >= (int)model.accessors.size() )
+        return 0;
+    return model.accessors[it->second].count;
+}
+
+bool GetTriangleIndices( const tinygltf::Model &model, const tinygltf::Primitive &prim, std::vector<uint32_t> &out )
+{
+    std::vector<uint32_t> source;
+    if( prim.indices >= 0 )
+    {
+        AccessorView view;
+        if( !GetAccessorView(model, prim.indices, &view) )
+            return false;
+        source.resize(view.count * view.components);
+        if( !source.empty() ) ConvertToU32(view, &source[0]);
+    }
+    else
+    {
+        size_t count = GetVertexCount(model, prim);
+        source.resize(count);
+        for( size_t i=0; i<count; ++i )
+            source[i] = (uint32_t)i;
+    }
+
+    out.clear();
+    switch(prim.mode)
+    {
+        case TINYGLTF_MODE_TRIANGLES:
+            out.swap(source);
+            out.resize(out.size() - out.size() % 3);
+            return true;
+
+        case TINYGLTF_MODE_TRIANGLE_STRIP:
+            // Every other triangle is flipped to keep the winding
+            for( size_t i=2; i<source.size(); ++i )
+            {
+                uint32_t a = source[i - 2], b = source[i - 1], c = source[i];
+                if( a == b || b == c || a == c ) continue;
+                if( i & 1 ) std::swap(a, b);
+                out.push_back(a); out.push_back(b); out.push_back(c);
+            }
+            return true;
+
+        case TINYGLTF_MODE_TRIANGLE_FAN:
+            for( size_t i=2; i<source.size(); ++i )
+            {
+                out.push_back(source[i - 1]);
+                out.push_back(source[i]);
+                out.push_back(source[0]);
+            }
+            return true;
+    }
+    return false;
+}
+
+int GetAttributeFloats( const tinygltf::Model &model, const tinygltf::Primitive &prim, const char *attribute, std::vector<float> &out )
+{
+    std::map<std::string, int>::const_iterator it = prim.attributes.find(attribute);
+    if( it == prim.attributes.end() )
+        return 0;
+
+    AccessorView view;
+    if( !GetAccessorView(model, it->second, &view) )
+        return 0;
+
+    out.resize(view.count * view.components);
+    if( !out.empty() ) ConvertToFloat(view, &out[0]);
+    return view.components;
+}
+
+void GatherVertices( const uint32_t *indices, size_t count, const GatherStream *streams, int numstreams )
+{
+    for( size_t i=0; i<count; ++i )
+    {
+        // Indices are random access into the sources, get the lines in flight early
+        if( i + GATHER_PREFETCH_DISTANCE < count )
+        {
+            uint32_t ahead = indices[i + GATHER_PREFETCH_DISTANCE];
+            for( int s=0; s<numstreams; ++s )
+                MESH_PREFETCH(streams[s].src + (size_t)ahead * streams[s].srccomponents);
+        }
+
+        uint32_t idx = indices[i];
+        for( int s=0; s<numstreams; ++s )
+        {
+            const GatherStream &stream = streams[s];
+            const float *src = stream.src + (size_t)idx * stream.srccomponents;
+            float *dst = stream.dst + i * stream.dststride;
+            int n = std::min(stream.srccomponents, stream.dstcomponents);
+            for( int c=0; c<n; ++c )
+                dst[c] = src[c];
+        }
+    }
+}
+
+bool BuildMeshData( const tinygltf::Model &model, const tinygltf::Primitive &prim, MeshData &out )
+{
+    GLTF_PROFILE("GltfBuildMeshData");
+    out.streams.clear();
+    out.indices.clear();
+    out.vertexcount = GetVertexCount(model, prim);
+    out.material = prim.material;
+    if( out.vertexcount == 0 || !GetTriangleIndices(model, prim, out.indices) )
+        return false;
+
+    for( const StreamAttribute *sa = g_StreamAttributes; sa->stream; ++sa )
+    {
+        MeshStream stream;
+        stream.name = sa->stream;
+        stream.components = GetAttributeFloats(model, prim, sa->attribute, stream.data);
+        if( stream.components == 0 ) continue;
+        // All streams must cover every vertex, drop the ones that don't
+        if( stream.data.size() / stream.components < out.vertexcount ) continue;
+        stream.data.resize(out.vertexcount * stream.components);
+        out.streams.push_back(stream);
+    }
+
+    for( size_t i=0; i<out.indices.size(); ++i )
+    {
+        if( out.indices[i] >= out.vertexcount )
+            return false;
+    }
+    return true;
+}
+
+const MeshStream *FindMeshStream( const MeshData &mesh, const char *name )
+{
+    for( size_t i=0; i<mesh.streams.size(); ++i )
+    {
+        if( mesh.streams[i].name == name )
+            return &mesh.streams[i];
+    }
+    return 0;
+}
+
+bool IndicesFitU16( const MeshData &mesh )
+{
+    return mesh.vertexcount <= 65536;
+}
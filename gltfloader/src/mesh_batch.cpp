@@ -0,0 +1,218 @@
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "mesh.h"
+#include "scene.h"
+#include "mesh_batch.h"
+#include "gltf_profile.h"
+
+static void Normalize3( float *v )
+{
+    float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if( len > 0.0f )
+    {
+        float inv = 1.0f / len;
+        v[0] *= inv; v[1] *= inv; v[2] *= inv;
+    }
+}
+
+static float Determinant3( const float *m )
+{
+    return m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+}
+
+// Cofactor matrix of the upper 3x3, which is the inverse transpose scaled by the
+//   determinant. Fine for normals since they are renormalized anyway.
+static void NormalMatrix( const float *m, float *n )
+{
+    float a = m[0], b = m[4], c = m[8];
+    float d = m[1], e = m[5], f = m[9];
+    float g = m[2], h = m[6], i = m[10];
+
+    // n is column major like m: n[col*3+row]
+    n[0] = e * i - f * h;  n[3] = f * g - d * i;  n[6] = d * h - e * g;
+    n[1] = c * h - b * i;  n[4] = a * i - c * g;  n[7] = b * g - a * h;
+    n[2] = b * f - c * e;  n[5] = c * d - a * f;  n[8] = a * e - b * d;
+
+    // Mirrored transforms flip the cofactors, keep the normals facing out
+    if( Determinant3(m) < 0.0f )
+        for( int k=0; k<9; ++k ) n[k] = -n[k];
+}
+
+void TransformMeshData( MeshData &mesh, const float *m )
+{
+    float nm[9];
+    NormalMatrix(m, nm);
+    bool mirrored = Determinant3(m) < 0.0f;
+
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        MeshStream &stream = mesh.streams[s];
+        int comps = stream.components;
+        if( comps < 3 ) continue;
+        float *v = stream.data.empty() ? 0 : &stream.data[0];
+
+        if( stream.name == "position" )
+        {
+            for( size_t i=0; i<mesh.vertexcount; ++i, v += comps )
+            {
+                float x = v[0], y = v[1], z = v[2];
+                v[0] = m[0] * x + m[4] * y + m[8] * z + m[12];
+                v[1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+                v[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+            }
+        }
+        else if( stream.name == "normal" )
+        {
+            for( size_t i=0; i<mesh.vertexcount; ++i, v += comps )
+            {
+                float x = v[0], y = v[1], z = v[2];
+                v[0] = nm[0] * x + nm[3] * y + nm[6] * z;
+                v[1] = nm[1] * x + nm[4] * y + nm[7] * z;
+                v[2] = nm[2] * x + nm[5] * y + nm[8] * z;
+                Normalize3(v);
+            }
+        }
+        else if( stream.name == "tangent" )
+        {
+            for( size_t i=0; i<mesh.vertexcount; ++i, v += comps )
+            {
+                float x = v[0], y = v[1], z = v[2];
+                v[0] = m[0] * x + m[4] * y + m[8] * z;
+                v[1] = m[1] * x + m[5] * y + m[9] * z;
+                v[2] = m[2] * x + m[6] * y + m[10] * z;
+                Normalize3(v);
+                if( mirrored && comps > 3 ) v[3] = -v[3];
+            }
+        }
+    }
+
+    // A mirror turns the triangles inside out, swap two corners to keep them front facing
+    if( mirrored )
+    {
+        for( size_t i=0; i + 2 < mesh.indices.size(); i += 3 )
+            std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+    }
+}
+
+static MeshStream *FindStream( MeshData &mesh, const std::string &name )
+{
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        if( mesh.streams[s].name == name ) return &mesh.streams[s];
+    }
+    return 0;
+}
+
+// Appends src to dst. Streams only in dst are zero filled for the new vertices,
+//   streams only in src are added and zero filled for the existing ones.
+static void AppendMeshData( MeshData &dst, const MeshData &src )
+{
+    size_t base = dst.vertexcount;
+    size_t total = base + src.vertexcount;
+
+    for( size_t s=0; s<src.streams.size(); ++s )
+    {
+        const MeshStream &in = src.streams[s];
+        MeshStream *out = FindStream(dst, in.name);
+        if( !out )
+        {
+            MeshStream stream;
+            stream.name = in.name;
+            stream.components = in.components;
+            dst.streams.push_back(stream);
+            out = &dst.streams.back();
+            out->data.assign(base * in.components, 0.0f);
+        }
+        out->data.reserve(total * out->components);
+
+        if( out->components == in.components )
+        {
+            out->data.insert(out->data.end(), in.data.begin(), in.data.end());
+        }
+        else
+        {
+            // Same stream with a different width (vec3 vs vec4 colors)
+            int copy = out->components < in.components ? out->components : in.components;
+            for( size_t v=0; v<src.vertexcount; ++v )
+            {
+                size_t at = out->data.size();
+                out->data.resize(at + out->components, 0.0f);
+                memcpy(&out->data[at], &in.data[v * in.components], copy * sizeof(float));
+                if( copy == 3 && out->components == 4 && in.name == "color" )
+                    out->data[at + 3] = 1.0f;
+            }
+        }
+    }
+
+    for( size_t s=0; s<dst.streams.size(); ++s )
+    {
+        MeshStream &stream = dst.streams[s];
+        stream.data.resize(total * stream.components, 0.0f);
+    }
+
+    dst.indices.reserve(dst.indices.size() + src.indices.size());
+    for( size_t i=0; i<src.indices.size(); ++i )
+        dst.indices.push_back((uint32_t)(src.indices[i] + base));
+    dst.vertexcount = total;
+}
+
+void BuildStaticBatches( const tinygltf::Model &model, int scene, std::vector<StaticBatch> &out )
+{
+    GLTF_PROFILE("GltfBuildStaticBatches");
+    out.clear();
+
+    std::vector<float> world;
+    std::vector<int> order;
+    ComputeWorldMatrices(model, scene, world, &order);
+
+    std::map<int, size_t> batches;      // material -> index in out
+    for( size_t o=0; o<order.size(); ++o )
+    {
+        int node = order[o];
+        int meshid = model.nodes[node].mesh;
+        if( meshid < 0 || meshid >= (int)model.meshes.size() ) continue;
+
+        const tinygltf::Mesh &mesh = model.meshes[meshid];
+        for( size_t p=0; p<mesh.primitives.size(); ++p )
+        {
+            MeshData data;
+            if( !BuildMeshData(model, mesh.primitives[p], data) || data.indices.empty() ) continue;
+            TransformMeshData(data, &world[node * 16]);
+
+            std::map<int, size_t>::iterator it = batches.find(data.material);
+            if( it == batches.end() )
+            {
+                it = batches.insert(std::make_pair(data.material, out.size())).first;
+                out.push_back(StaticBatch());
+                out.back().material = data.material;
+                out.back().mesh.material = data.material;
+            }
+
+            StaticBatch &batch = out[it->second];
+            BatchRange range;
+            range.node = node;
+            range.mesh = meshid;
+            range.primitive = (int)p;
+            range.firstindex = batch.mesh.indices.size();
+            range.indexcount = data.indices.size();
+            AppendMeshData(batch.mesh, data);
+            batch.ranges.push_back(range);
+        }
+    }
+
+    // Stable output regardless of node order
+    std::vector<StaticBatch> sorted;
+    sorted.reserve(out.size());
+    for( std::map<int, size_t>::iterator it = batches.begin(); it != batches.end(); ++it )
+    {
+        sorted.push_back(StaticBatch());
+        std::swap(sorted.back(), out[it->second]);
+    }
+    out.swap(sorted);
+}
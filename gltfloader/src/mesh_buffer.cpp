@@ -0,0 +1,150 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#include "mesh_buffer.h"
+
+bool CreateVertexBuffer( const MeshData &mesh, dmBuffer::HBuffer *out )
+{
+    DM_PROFILE("GltfCreateVertexBuffer");
+    if( mesh.streams.empty() || mesh.vertexcount == 0 )
+        return false;
+
+    std::vector<dmBuffer::StreamDeclaration> streams_decl(mesh.streams.size());
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        memset(&streams_decl[s], 0, sizeof(dmBuffer::StreamDeclaration));
+        streams_decl[s].m_Name = dmHashString64(mesh.streams[s].name.c_str());
+        streams_decl[s].m_Type = dmBuffer::VALUE_TYPE_FLOAT32;
+        streams_decl[s].m_Count = (uint8_t)mesh.streams[s].components;
+    }
+
+    dmBuffer::HBuffer buffer;
+    dmBuffer::Result r = dmBuffer::Create(mesh.vertexcount, &streams_decl[0], streams_decl.size(), &buffer);
+    if( r != dmBuffer::RESULT_OK )
+        return false;
+
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        const MeshStream &stream = mesh.streams[s];
+        float* bytes = 0x0;
+        uint32_t count = 0;
+        uint32_t components = 0;
+        uint32_t stride = 0;
+        r = dmBuffer::GetStream(buffer, streams_decl[s].m_Name, (void**)&bytes, &count, &components, &stride);
+        if( r != dmBuffer::RESULT_OK ) continue;
+
+        const float *src = &stream.data[0];
+        for( uint32_t i=0; i<count; ++i, bytes += stride, src += stream.components )
+            memcpy(bytes, src, sizeof(float) * stream.components);
+    }
+
+    dmBuffer::ValidateBuffer(buffer);
+    *out = buffer;
+    return true;
+}
+
+bool CreateIndexBuffer( const MeshData &mesh, dmBuffer::HBuffer *out )
+{
+    DM_PROFILE("GltfCreateIndexBuffer");
+    if( mesh.indices.empty() )
+        return false;
+
+    bool u16 = IndicesFitU16(mesh);
+    dmBuffer::StreamDeclaration streams_decl[] = {
+        { dmHashString64("indices"), u16 ? dmBuffer::VALUE_TYPE_UINT16 : dmBuffer::VALUE_TYPE_UINT32, 1 }
+    };
+
+    dmBuffer::HBuffer buffer;
+    dmBuffer::Result r = dmBuffer::Create(mesh.indices.size(), streams_decl, 1, &buffer);
+    if( r != dmBuffer::RESULT_OK )
+        return false;
+
+    uint8_t* data = 0;
+    uint32_t datasize = 0;
+    dmBuffer::GetBytes(buffer, (void**)&data, &datasize);
+    if( u16 )
+    {
+        uint16_t *dst = (uint16_t *)data;
+        for( size_t i=0; i<mesh.indices.size(); ++i )
+            dst[i] = (uint16_t)mesh.indices[i];
+    }
+    else
+    {
+        memcpy(data, &mesh.indices[0], mesh.indices.size() * sizeof(uint32_t));
+    }
+
+    dmBuffer::ValidateBuffer(buffer);
+    *out = buffer;
+    return true;
+}
+
+bool CreateUnindexedBuffer( const MeshData &mesh, dmBuffer::HBuffer *out )
+{
+    DM_PROFILE("GltfCreateUnindexedBuffer");
+    if( mesh.streams.empty() || mesh.indices.empty() )
+        return false;
+
+    std::vector<dmBuffer::StreamDeclaration> streams_decl(mesh.streams.size());
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        memset(&streams_decl[s], 0, sizeof(dmBuffer::StreamDeclaration));
+        streams_decl[s].m_Name = dmHashString64(mesh.streams[s].name.c_str());
+        streams_decl[s].m_Type = dmBuffer::VALUE_TYPE_FLOAT32;
+        streams_decl[s].m_Count = (uint8_t)mesh.streams[s].components;
+    }
+
+    dmBuffer::HBuffer buffer;
+    dmBuffer::Result r = dmBuffer::Create(mesh.indices.size(), &streams_decl[0], streams_decl.size(), &buffer);
+    if( r != dmBuffer::RESULT_OK )
+        return false;
+
+    std::vector<GatherStream> gather;
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        GatherStream stream;
+        uint32_t count = 0;
+        uint32_t components = 0;
+        uint32_t stride = 0;
+        r = dmBuffer::GetStream(buffer, streams_decl[s].m_Name, (void**)&stream.dst, &count, &components, &stride);
+        if( r != dmBuffer::RESULT_OK ) continue;
+        stream.src = &mesh.streams[s].data[0];
+        stream.srccomponents = mesh.streams[s].components;
+        stream.dstcomponents = components;
+        stream.dststride = stride;
+        gather.push_back(stream);
+    }
+
+    if( !gather.empty() )
+        GatherVertices(&mesh.indices[0], mesh.indices.size(), &gather[0], (int)gather.size());
+
+    dmBuffer::ValidateBuffer(buffer);
+    *out = buffer;
+    return true;
+}
+
+void PushMeshBuffers( lua_State *L, const MeshData &mesh )
+{
+    dmBuffer::HBuffer vertices = 0;
+    dmBuffer::HBuffer indices = 0;
+
+    if( CreateVertexBuffer(mesh, &vertices) )
+    {
+        dmScript::LuaHBuffer luabuffer(vertices, dmScript::OWNER_LUA);
+        dmScript::PushBuffer(L, luabuffer);
+    }
+    else
+        lua_pushnil(L);
+
+    if( CreateIndexBuffer(mesh, &indices) )
+    {
+        dmScript::LuaHBuffer luabuffer(indices, dmScript::OWNER_LUA);
+        dmScript::PushBuffer(L, luabuffer);
+    }
+    else
+        lua_pushnil(L);
+}
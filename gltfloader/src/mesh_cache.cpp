@@ -0,0 +1,1065 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "tiny_gltf.h"
+#include "accessor.h"
+#include "gltf_parse.h"
+#include "mesh.h"
+#include "mesh_cache.h"
+
+// Writer side: everything goes into one growing blob, offsets are from its start
+
+typedef struct BakeWriter {
+    std::vector<uint8_t>    blob;
+    std::string             strings;
+} BakeWriter;
+
+static uint64_t Align( BakeWriter &w )
+{
+    size_t size = (w.blob.size() + BAKE_ALIGN - 1) & ~(size_t)(BAKE_ALIGN - 1);
+    w.blob.resize(size, 0);
+    return size;
+}
+
+static uint64_t Append( BakeWriter &w, const void *data, size_t size )
+{
+    uint64_t offset = Align(w);
+    if( size > 0 )
+    {
+        w.blob.resize(offset + size);
+        memcpy(&w.blob[offset], data, size);
+    }
+    return offset;
+}
+
+// Reserves a zeroed, aligned block for a table that is filled in later
+static uint64_t Reserve( BakeWriter &w, size_t size )
+{
+    uint64_t offset = Align(w);
+    w.blob.resize(offset + size, 0);
+    return offset;
+}
+
+template<typename T> static T *At( BakeWriter &w, uint64_t offset )
+{
+    return (T *)&w.blob[offset];
+}
+
+// Offset 0 is the empty string
+static uint32_t AddString( BakeWriter &w, const std::string &s )
+{
+    if( s.empty() ) return 0;
+    uint32_t offset = (uint32_t)w.strings.size();
+    w.strings.append(s.c_str(), s.size() + 1);
+    return offset;
+}
+
+static int32_t AlphaModeToInt( const std::string &mode )
+{
+    if( mode == "MASK" ) return 1;
+    if( mode == "BLEND" ) return 2;
+    return 0;
+}
+
+static const char *AlphaModeToString( int32_t mode )
+{
+    if( mode == 1 ) return "MASK";
+    if( mode == 2 ) return "BLEND";
+    return "OPAQUE";
+}
+
+static void WritePrimitive( BakeWriter &w, const tinygltf::Model &model, uint64_t entry, const BakeMesh &source )
+{
+    const MeshData &mesh = source.data;
+    // Streams first, the entry points at them
+    std::vector<BakeStream> streams(mesh.streams.size());
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        const MeshStream &stream = mesh.streams[s];
+        BakeStream &bs = streams[s];
+        memset(&bs, 0, sizeof(bs));
+        strncpy(bs.name, stream.name.c_str(), sizeof(bs.name) - 1);
+        bs.components = stream.components;
+        bs.data = Append(w, stream.data.empty() ? 0 : &stream.data[0], stream.data.size() * sizeof(float));
+
+        for( int c=0; c<4; ++c ) { bs.min[c] = 0.0f; bs.max[c] = 0.0f; }
+        for( int c=0; c<stream.components && c<4; ++c )
+        {
+            float vmin = mesh.vertexcount ? stream.data[c] : 0.0f;
+            float vmax = vmin;
+            for( size_t v=1; v<mesh.vertexcount; ++v )
+            {
+                float x = stream.data[v * stream.components + c];
+                if( x < vmin ) vmin = x;
+                if( x > vmax ) vmax = x;
+            }
+            bs.min[c] = vmin;
+            bs.max[c] = vmax;
+        }
+    }
+    uint64_t streamsoffset = Append(w, streams.empty() ? 0 : &streams[0], streams.size() * sizeof(BakeStream));
+
+    bool u16 = IndicesFitU16(mesh);
+    uint64_t indicesoffset;
+    if( u16 )
+    {
+        std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+        indicesoffset = Append(w, indices.empty() ? 0 : &indices[0], indices.size() * sizeof(uint16_t));
+    }
+    else
+        indicesoffset = Append(w, &mesh.indices[0], mesh.indices.size() * sizeof(uint32_t));
+
+    BakePrimitive *bp = At<BakePrimitive>(w, entry);
+    bp->meshname = AddString(w, model.meshes[source.mesh].name);
+    bp->mesh = source.mesh;
+    bp->primitive = source.primitive;
+    bp->lod = source.lod;
+    bp->material = mesh.material;
+    bp->vertexcount = (uint32_t)mesh.vertexcount;
+    bp->indexcount = (uint32_t)mesh.indices.size();
+    bp->indexsize = u16 ? 2 : 4;
+    bp->numstreams = (uint32_t)streams.size();
+    bp->streams = streamsoffset;
+    bp->indices = indicesoffset;
+}
+
+static void FillNode( BakeWriter &w, const tinygltf::Node &node, BakeNode *bn )
+{
+    bn->name = AddString(w, node.name);
+    bn->mesh = node.mesh;
+    bn->numchildren = (uint32_t)node.children.size();
+    bn->hasmatrix = node.matrix.size() == 16 ? 1 : 0;
+
+    for( int i=0; i<3; ++i ) bn->translation[i] = node.translation.size() == 3 ? (float)node.translation[i] : 0.0f;
+    for( int i=0; i<4; ++i ) bn->rotation[i] = node.rotation.size() == 4 ? (float)node.rotation[i] : (i == 3 ? 1.0f : 0.0f);
+    for( int i=0; i<3; ++i ) bn->scale[i] = node.scale.size() == 3 ? (float)node.scale[i] : 1.0f;
+    for( int i=0; i<16; ++i ) bn->matrix[i] = bn->hasmatrix ? (float)node.matrix[i] : ((i % 5) == 0 ? 1.0f : 0.0f);
+}
+
+static void FillMaterial( BakeWriter &w, const tinygltf::Material &mat, BakeMaterial *bm )
+{
+    const tinygltf::PbrMetallicRoughness &pbr = mat.pbrMetallicRoughness;
+    bm->name = AddString(w, mat.name);
+    bm->alphamode = AlphaModeToInt(mat.alphaMode);
+    bm->alphacutoff = (float)mat.alphaCutoff;
+    bm->doublesided = mat.doubleSided ? 1 : 0;
+    for( int i=0; i<4; ++i ) bm->basecolor[i] = pbr.baseColorFactor.size() == 4 ? (float)pbr.baseColorFactor[i] : 1.0f;
+    for( int i=0; i<3; ++i ) bm->emissive[i] = mat.emissiveFactor.size() == 3 ? (float)mat.emissiveFactor[i] : 0.0f;
+    bm->metallic = (float)pbr.metallicFactor;
+    bm->roughness = (float)pbr.roughnessFactor;
+    bm->normalscale = (float)mat.normalTexture.scale;
+    bm->occlusionstrength = (float)mat.occlusionTexture.strength;
+    bm->basecolortexture = pbr.baseColorTexture.index;
+    bm->metallicroughnesstexture = pbr.metallicRoughnessTexture.index;
+    bm->normaltexture = mat.normalTexture.index;
+    bm->occlusiontexture = mat.occlusionTexture.index;
+    bm->emissivetexture = mat.emissiveTexture.index;
+    bm->texcoords[0] = pbr.baseColorTexture.texCoord;
+    bm->texcoords[1] = pbr.metallicRoughnessTexture.texCoord;
+    bm->texcoords[2] = mat.normalTexture.texCoord;
+    bm->texcoords[3] = mat.occlusionTexture.texCoord;
+    bm->texcoords[4] = mat.emissiveTexture.texCoord;
+}
+
+static bool GetFloats( const tinygltf::Model &model, int accessor, std::vector<float> &out, int *components )
+{
+    AccessorView view;
+    if( !GetAccessorView(model, accessor, &view) ) return false;
+    out.resize(view.count * view.components);
+    if( !out.empty() ) ConvertToFloat(view, &out[0]);
+    *components = view.components;
+    return true;
+}
+
+static void WriteAnimation( BakeWriter &w, const tinygltf::Model &model, const tinygltf::Animation &anim, uint64_t entry )
+{
+    std::vector<BakeChannel> channels;
+    for( size_t c=0; c<anim.channels.size(); ++c )
+    {
+        const tinygltf::AnimationChannel &channel = anim.channels[c];
+        if( channel.sampler < 0 || channel.sampler >= (int)anim.samplers.size() ) continue;
+        const tinygltf::AnimationSampler &sampler = anim.samplers[channel.sampler];
+
+        std::vector<float> times, values;
+        int timecomps = 0, components = 0;
+        if( !GetFloats(model, sampler.input, times, &timecomps) || timecomps != 1 ) continue;
+        if( !GetFloats(model, sampler.output, values, &components) ) continue;
+
+        BakeChannel bc;
+        memset(&bc, 0, sizeof(bc));
+        bc.node = channel.target_node;
+        bc.path = AddString(w, channel.target_path);
+        bc.interpolation = AddString(w, sampler.interpolation);
+        bc.numkeys = (uint32_t)times.size();
+        bc.numvalues = (uint32_t)(values.size() / components);
+        bc.components = components;
+        bc.times = Append(w, times.empty() ? 0 : &times[0], times.size() * sizeof(float));
+        bc.values = Append(w, values.empty() ? 0 : &values[0], values.size() * sizeof(float));
+        channels.push_back(bc);
+    }
+
+    uint64_t offset = Append(w, channels.empty() ? 0 : &channels[0], channels.size() * sizeof(BakeChannel));
+    BakeAnimation *ba = At<BakeAnimation>(w, entry);
+    ba->name = AddString(w, anim.name);
+    ba->numchannels = (uint32_t)channels.size();
+    ba->channels = offset;
+}
+
+template<typename T> static bool HasExtras( const T &object )
+{
+    return object.extras.Type() != tinygltf::NULL_TYPE || !object.extensions.empty();
+}
+
+static bool MaterialHasExtras( const tinygltf::Material &mat )
+{
+    const tinygltf::PbrMetallicRoughness &pbr = mat.pbrMetallicRoughness;
+    return HasExtras(mat) || HasExtras(pbr) || HasExtras(pbr.baseColorTexture) || HasExtras(pbr.metallicRoughnessTexture)
+        || HasExtras(mat.normalTexture) || HasExtras(mat.occlusionTexture) || HasExtras(mat.emissiveTexture);
+}
+
+static bool IsStreamAttribute( const std::string &attribute )
+{
+    for( const StreamAttribute *sa = g_StreamAttributes; sa->stream; ++sa )
+    {
+        if( attribute == sa->attribute ) return true;
+    }
+    return false;
+}
+
+static bool CannotBake( std::string *reason, const std::string &what )
+{
+    if( reason ) *reason = "Not baked, the model has " + what;
+    return false;
+}
+
+bool CanBakeModel( const tinygltf::Model &model, std::string *reason )
+{
+    if( !model.skins.empty() ) return CannotBake(reason, "skins");
+    if( !model.cameras.empty() ) return CannotBake(reason, "cameras");
+    if( !model.lights.empty() ) return CannotBake(reason, "lights");
+    if( !model.extensionsUsed.empty() || !model.extensionsRequired.empty() || HasExtras(model) || HasExtras(model.asset) )
+        return CannotBake(reason, "extensions or extras");
+
+    for( size_t n=0; n<model.nodes.size(); ++n )
+    {
+        const tinygltf::Node &node = model.nodes[n];
+        if( node.skin >= 0 || node.camera >= 0 ) return CannotBake(reason, "skinned or camera nodes");
+        if( !node.weights.empty() ) return CannotBake(reason, "morph target weights");
+        if( HasExtras(node) ) return CannotBake(reason, "node extensions or extras");
+    }
+
+    for( size_t m=0; m<model.meshes.size(); ++m )
+    {
+        const tinygltf::Mesh &mesh = model.meshes[m];
+        if( !mesh.weights.empty() ) return CannotBake(reason, "morph target weights");
+        if( HasExtras(mesh) ) return CannotBake(reason, "mesh extensions or extras");
+        for( size_t p=0; p<mesh.primitives.size(); ++p )
+        {
+            const tinygltf::Primitive &prim = mesh.primitives[p];
+            if( prim.mode != TINYGLTF_MODE_TRIANGLES ) return CannotBake(reason, "primitives that are not triangle lists");
+            if( !prim.targets.empty() ) return CannotBake(reason, "morph targets");
+            if( HasExtras(prim) ) return CannotBake(reason, "primitive extensions or extras");
+            for( std::map<std::string, int>::const_iterator it = prim.attributes.begin(); it != prim.attributes.end(); ++it )
+            {
+                if( !IsStreamAttribute(it->first) ) return CannotBake(reason, "the attribute " + it->first);
+            }
+        }
+    }
+
+    for( size_t m=0; m<model.materials.size(); ++m )
+    {
+        if( MaterialHasExtras(model.materials[m]) ) return CannotBake(reason, "material extensions or extras");
+    }
+    for( size_t t=0; t<model.textures.size(); ++t )
+    {
+        if( HasExtras(model.textures[t]) ) return CannotBake(reason, "texture extensions or extras");
+    }
+    for( size_t s=0; s<model.samplers.size(); ++s )
+    {
+        if( HasExtras(model.samplers[s]) ) return CannotBake(reason, "sampler extensions or extras");
+    }
+    for( size_t i=0; i<model.images.size(); ++i )
+    {
+        if( HasExtras(model.images[i]) ) return CannotBake(reason, "image extensions or extras");
+    }
+    for( size_t s=0; s<model.scenes.size(); ++s )
+    {
+        if( HasExtras(model.scenes[s]) ) return CannotBake(reason, "scene extensions or extras");
+    }
+    for( size_t a=0; a<model.animations.size(); ++a )
+    {
+        const tinygltf::Animation &anim = model.animations[a];
+        if( HasExtras(anim) ) return CannotBake(reason, "animation extensions or extras");
+        for( size_t c=0; c<anim.channels.size(); ++c )
+        {
+            const tinygltf::AnimationChannel &channel = anim.channels[c];
+            if( HasExtras(channel) || channel.target_extras.Type() != tinygltf::NULL_TYPE || !channel.target_extensions.empty() )
+                return CannotBake(reason, "animation extensions or extras");
+        }
+        for( size_t s=0; s<anim.samplers.size(); ++s )
+        {
+            if( HasExtras(anim.samplers[s]) ) return CannotBake(reason, "animation extensions or extras");
+        }
+    }
+    return true;
+}
+
+static bool IsExternalUri( const std::string &uri )
+{
+    return !uri.empty() && uri.compare(0, 5, "data:") != 0;
+}
+
+// Up to and including the last separator, empty for a bare file name
+static std::string GetSourceDir( const char *source )
+{
+    std::string dir(source);
+    size_t slash = dir.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : dir.substr(0, slash + 1);
+}
+
+static void AddDependency( std::vector<std::string> &uris, const std::string &uri )
+{
+    if( !IsExternalUri(uri) ) return;
+    std::string decoded;
+    if( !tinygltf::URIDecode(uri, &decoded, 0) ) decoded = uri;
+    if( std::find(uris.begin(), uris.end(), decoded) == uris.end() ) uris.push_back(decoded);
+}
+
+// The source first (an empty uri), then the external buffers and images
+static void GetDependencies( const tinygltf::Model &model, std::vector<std::string> &uris )
+{
+    uris.assign(1, std::string());
+    for( size_t b=0; b<model.buffers.size(); ++b )
+        AddDependency(uris, model.buffers[b].uri);
+    for( size_t i=0; i<model.images.size(); ++i )
+        AddDependency(uris, model.images[i].uri);
+}
+
+static std::string GetDependencyPath( const char *source, const std::string &uri )
+{
+    return uri.empty() ? std::string(source) : GetSourceDir(source) + uri;
+}
+
+std::string GetMeshCachePath( const char *gltf_filename )
+{
+    return std::string(gltf_filename) + BAKE_EXTENSION;
+}
+
+std::string GetRuntimeCachePath( const char *gltf_filename )
+{
+    // The source path below BAKE_CACHE_DIR, a leading / or ./ dropped and .. kept
+    // from climbing out of it
+    std::string path = BAKE_CACHE_DIR;
+    const char *p = gltf_filename;
+    while( *p )
+    {
+        const char *end = strchr(p, '/');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if( len == 2 && p[0] == '.' && p[1] == '.' ) path += "/__";
+        else if( len > 0 && !(len == 1 && p[0] == '.') ) path += "/" + std::string(p, len);
+        p += end ? len + 1 : len;
+    }
+    return path + BAKE_EXTENSION;
+}
+
+// mkdir -p for the directory part of path
+static void MakeParentDirs( const std::string &path )
+{
+    for( size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1) )
+        mkdir(path.substr(0, slash).c_str(), 0755);
+}
+
+bool GetSourceStamp( const char *path, uint64_t *size, uint64_t *mtime )
+{
+    struct stat st;
+    if( stat(path, &st) != 0 ) return false;
+    *size = (uint64_t)st.st_size;
+    *mtime = (uint64_t)st.st_mtime;
+    return true;
+}
+
+bool IsToolBake( const char *path )
+{
+    FILE *f = fopen(path, "rb");
+    if( !f ) return false;
+    BakeHeader header;
+    bool ok = fread(&header, 1, sizeof(header), f) == sizeof(header);
+    fclose(f);
+    return ok && memcmp(header.magic, BAKE_MAGIC, sizeof(header.magic)) == 0
+              && header.version == BAKE_VERSION && (header.flags & BAKE_FLAG_TOOL) != 0;
+}
+
+#define FNV_OFFSET  0xcbf29ce484222325ull
+#define FNV_PRIME   0x100000001b3ull
+
+static uint64_t HashBytes( uint64_t h, const uint8_t *data, size_t size )
+{
+    for( size_t i=0; i<size; ++i )
+        h = (h ^ data[i]) * FNV_PRIME;
+    return h;
+}
+
+static bool HashFile( const char *path, uint64_t *hash )
+{
+    FILE *f = fopen(path, "rb");
+    if( !f ) return false;
+    uint64_t h = FNV_OFFSET;
+    uint8_t chunk[64 * 1024];
+    size_t n;
+    while( (n = fread(chunk, 1, sizeof(chunk), f)) > 0 )
+        h = HashBytes(h, chunk, n);
+    bool ok = ferror(f) == 0;
+    fclose(f);
+    *hash = h;
+    return ok;
+}
+
+bool CollectBakeMeshes( const tinygltf::Model &model, std::vector<BakeMesh> &out )
+{
+    // Triangle primitives only, points and lines have no place in a mesh buffer
+    bool all = true;
+    for( size_t m=0; m<model.meshes.size(); ++m )
+    {
+        for( size_t p=0; p<model.meshes[m].primitives.size(); ++p )
+        {
+            out.push_back(BakeMesh());
+            BakeMesh &mesh = out.back();
+            mesh.mesh = (int)m;
+            mesh.primitive = (int)p;
+            mesh.lod = 0;
+            if( !BuildMeshData(model, model.meshes[m].primitives[p], mesh.data) || mesh.data.indices.empty() )
+            {
+                out.pop_back();
+                all = false;
+            }
+        }
+    }
+    return all;
+}
+
+bool WriteMeshCache( const tinygltf::Model &model, const char *path, const char *source, std::string *err )
+{
+    std::vector<BakeMesh> meshes;
+    if( !CollectBakeMeshes(model, meshes) )
+    {
+        if( err ) *err = "Not baked, a primitive could not be converted to a triangle list";
+        return false;
+    }
+    return WriteMeshCache(model, meshes, path, source, 0, err);
+}
+
+bool WriteMeshCache( const tinygltf::Model &model, const std::vector<BakeMesh> &meshes, const char *path,
+                     const char *source, uint32_t flags, std::string *err )
+{
+    std::string reason;
+    if( !CanBakeModel(model, &reason) )
+    {
+        if( err ) *err = reason;
+        return false;
+    }
+
+    BakeWriter w;
+    w.strings.assign(1, '\0');
+    w.blob.reserve(1024 * 1024);
+
+    Reserve(w, sizeof(BakeHeader));
+
+    uint32_t numlods = 0;
+    uint64_t primitives = Reserve(w, meshes.size() * sizeof(BakePrimitive));
+    for( size_t i=0; i<meshes.size(); ++i )
+    {
+        if( meshes[i].mesh < 0 || meshes[i].mesh >= (int)model.meshes.size() || meshes[i].data.indices.empty() )
+        {
+            if( err ) *err = "Baked primitive without a valid mesh or indices";
+            return false;
+        }
+        WritePrimitive(w, model, primitives + i * sizeof(BakePrimitive), meshes[i]);
+        if( (uint32_t)meshes[i].lod > numlods ) numlods = meshes[i].lod;
+    }
+
+    std::vector<int32_t> parents(model.nodes.size(), -1);
+    for( size_t n=0; n<model.nodes.size(); ++n )
+    {
+        for( size_t c=0; c<model.nodes[n].children.size(); ++c )
+        {
+            int child = model.nodes[n].children[c];
+            if( child >= 0 && child < (int)parents.size() ) parents[child] = (int32_t)n;
+        }
+    }
+    uint64_t nodes = Reserve(w, model.nodes.size() * sizeof(BakeNode));
+    for( size_t n=0; n<model.nodes.size(); ++n )
+    {
+        const std::vector<int> &children = model.nodes[n].children;
+        uint64_t childoffset = Append(w, children.empty() ? 0 : &children[0], children.size() * sizeof(int32_t));
+        BakeNode *bn = At<BakeNode>(w, nodes + n * sizeof(BakeNode));
+        FillNode(w, model.nodes[n], bn);
+        bn->parent = parents[n];
+        bn->children = childoffset;
+    }
+
+    uint64_t materials = Reserve(w, model.materials.size() * sizeof(BakeMaterial));
+    for( size_t m=0; m<model.materials.size(); ++m )
+        FillMaterial(w, model.materials[m], At<BakeMaterial>(w, materials + m * sizeof(BakeMaterial)));
+
+    uint64_t textures = Reserve(w, model.textures.size() * sizeof(BakeTexture));
+    for( size_t t=0; t<model.textures.size(); ++t )
+    {
+        BakeTexture *bt = At<BakeTexture>(w, textures + t * sizeof(BakeTexture));
+        bt->name = AddString(w, model.textures[t].name);
+        bt->source = model.textures[t].source;
+        bt->sampler = model.textures[t].sampler;
+    }
+
+    uint64_t samplers = Reserve(w, model.samplers.size() * sizeof(BakeSampler));
+    for( size_t s=0; s<model.samplers.size(); ++s )
+    {
+        const tinygltf::Sampler &sampler = model.samplers[s];
+        BakeSampler *bs = At<BakeSampler>(w, samplers + s * sizeof(BakeSampler));
+        bs->name = AddString(w, sampler.name);
+        bs->minfilter = sampler.minFilter;
+        bs->magfilter = sampler.magFilter;
+        bs->wraps = sampler.wrapS;
+        bs->wrapt = sampler.wrapT;
+    }
+
+    uint64_t images = Reserve(w, model.images.size() * sizeof(BakeImage));
+    for( size_t i=0; i<model.images.size(); ++i )
+    {
+        const tinygltf::Image &image = model.images[i];
+        if( !image.as_is && !image.image.empty() )
+        {
+            if( err ) *err = "Images must still be encoded to bake them (load with lazy images)";
+            return false;
+        }
+        // The encoded bytes go after the string table, see imagedata
+        BakeImage *bi = At<BakeImage>(w, images + i * sizeof(BakeImage));
+        bi->name = AddString(w, image.name);
+        bi->mimetype = AddString(w, image.mimeType);
+        bi->uri = AddString(w, image.uri);
+        bi->size = image.image.size();
+    }
+
+    uint64_t scenes = Reserve(w, model.scenes.size() * sizeof(BakeScene));
+    for( size_t s=0; s<model.scenes.size(); ++s )
+    {
+        const std::vector<int> &roots = model.scenes[s].nodes;
+        uint64_t rootoffset = Append(w, roots.empty() ? 0 : &roots[0], roots.size() * sizeof(int32_t));
+        BakeScene *bs = At<BakeScene>(w, scenes + s * sizeof(BakeScene));
+        bs->name = AddString(w, model.scenes[s].name);
+        bs->numnodes = (uint32_t)roots.size();
+        bs->nodes = rootoffset;
+    }
+
+    uint64_t animations = Reserve(w, model.animations.size() * sizeof(BakeAnimation));
+    for( size_t a=0; a<model.animations.size(); ++a )
+        WriteAnimation(w, model, model.animations[a], animations + a * sizeof(BakeAnimation));
+
+    std::vector<std::string> uris;
+    GetDependencies(model, uris);
+    std::vector<BakeDependency> deps(uris.size());
+    for( size_t d=0; d<uris.size(); ++d )
+    {
+        memset(&deps[d], 0, sizeof(BakeDependency));
+        std::string file = GetDependencyPath(source, uris[d]);
+        if( !GetSourceStamp(file.c_str(), &deps[d].size, &deps[d].mtime) || !HashFile(file.c_str(), &deps[d].hash) )
+        {
+            if( err ) *err = "Failed to stamp " + file;
+            return false;
+        }
+        deps[d].uri = AddString(w, uris[d]);
+    }
+    uint64_t dependencies = Append(w, &deps[0], deps.size() * sizeof(BakeDependency));
+
+    uint64_t strings = Append(w, w.strings.data(), w.strings.size());
+
+    uint64_t imagedata = Align(w);
+    for( size_t i=0; i<model.images.size(); ++i )
+    {
+        const std::vector<unsigned char> &bytes = model.images[i].image;
+        uint64_t data = Append(w, bytes.empty() ? 0 : &bytes[0], bytes.size());
+        At<BakeImage>(w, images + i * sizeof(BakeImage))->data = data;
+    }
+    Align(w);
+
+    BakeHeader *header = At<BakeHeader>(w, 0);
+    memcpy(header->magic, BAKE_MAGIC, sizeof(header->magic));
+    header->version = BAKE_VERSION;
+    header->headersize = sizeof(BakeHeader);
+    header->filesize = w.blob.size();
+    header->defaultscene = model.defaultScene;
+    header->nummeshes = (uint32_t)model.meshes.size();
+    header->numprimitives = (uint32_t)meshes.size();
+    header->numnodes = (uint32_t)model.nodes.size();
+    header->nummaterials = (uint32_t)model.materials.size();
+    header->numtextures = (uint32_t)model.textures.size();
+    header->numsamplers = (uint32_t)model.samplers.size();
+    header->numimages = (uint32_t)model.images.size();
+    header->numscenes = (uint32_t)model.scenes.size();
+    header->numanimations = (uint32_t)model.animations.size();
+    header->numdependencies = (uint32_t)deps.size();
+    header->numlods = numlods;
+    header->stringsize = (uint32_t)w.strings.size();
+    header->flags = flags;
+    header->primitives = primitives;
+    header->nodes = nodes;
+    header->materials = materials;
+    header->textures = textures;
+    header->samplers = samplers;
+    header->images = images;
+    header->scenes = scenes;
+    header->animations = animations;
+    header->dependencies = dependencies;
+    header->strings = strings;
+    header->imagedata = imagedata;
+
+    std::string temppath = std::string(path) + ".tmp";
+    MakeParentDirs(path);
+    FILE *f = fopen(temppath.c_str(), "wb");
+    if( !f )
+    {
+        if( err ) *err = "Failed to open " + temppath + " for writing";
+        return false;
+    }
+    bool ok = fwrite(&w.blob[0], 1, w.blob.size(), f) == w.blob.size();
+    ok = (fclose(f) == 0) && ok;
+    if( ok )
+    {
+        remove(path);
+        ok = rename(temppath.c_str(), path) == 0;
+    }
+    if( !ok )
+    {
+        remove(temppath.c_str());
+        if( err ) *err = std::string("Failed to write ") + path;
+    }
+    return ok;
+}
+
+// Reader side
+
+// A view of the bake bytes, everything read from it is range checked against size
+typedef struct BakeFile {
+    const uint8_t   *data;
+    uint64_t        size;
+} BakeFile;
+
+// Where the bytes live: a mapping of the file on disk or a copy read through the
+// model file reader (a bundle has no file to map)
+typedef struct BakeStorage {
+    std::vector<unsigned char>  bytes;
+    void                        *mapping;
+    uint64_t                    mappingsize;
+} BakeStorage;
+
+static bool OpenBake( const char *path, BakeStorage &storage, BakeFile &file )
+{
+    storage.mapping = 0;
+    storage.mappingsize = 0;
+    file.data = 0;
+    file.size = 0;
+#if !defined(_WIN32)
+    int fd = open(path, O_RDONLY);
+    if( fd >= 0 )
+    {
+        struct stat st;
+        void *data = MAP_FAILED;
+        if( fstat(fd, &st) == 0 && st.st_size > 0 )
+            data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if( data == MAP_FAILED ) return false;
+        storage.mapping = data;
+        storage.mappingsize = st.st_size;
+        file.data = (const uint8_t *)data;
+        file.size = st.st_size;
+        return true;
+    }
+#endif
+    std::string err;
+    if( !ReadModelFile(path, &storage.bytes, &err) || storage.bytes.empty() ) return false;
+    file.data = &storage.bytes[0];
+    file.size = storage.bytes.size();
+    return true;
+}
+
+static void CloseBake( BakeStorage &storage )
+{
+#if !defined(_WIN32)
+    if( storage.mapping ) munmap(storage.mapping, storage.mappingsize);
+#endif
+    storage.mapping = 0;
+    std::vector<unsigned char>().swap(storage.bytes);
+}
+
+// Every offset/count pair read from the file is checked before it is used
+static bool InRange( const BakeFile &file, uint64_t offset, uint64_t count, uint64_t elementsize )
+{
+    if( count == 0 ) return true;
+    if( offset > file.size || elementsize == 0 ) return false;
+    return count <= (file.size - offset) / elementsize;
+}
+
+static std::string GetString( const BakeFile &file, const BakeHeader *header, uint32_t offset )
+{
+    if( offset == 0 || offset >= header->stringsize ) return std::string();
+    const char *s = (const char *)file.data + header->strings + offset;
+    size_t len = strnlen(s, header->stringsize - offset);
+    return std::string(s, len);
+}
+
+static const char *StreamAttributeName( const char *stream )
+{
+    for( const StreamAttribute *sa = g_StreamAttributes; sa->stream; ++sa )
+    {
+        if( strcmp(sa->stream, stream) == 0 ) return sa->attribute;
+    }
+    return 0;
+}
+
+static int AccessorTypeForComponents( uint32_t components )
+{
+    switch( components )
+    {
+        case 1: return TINYGLTF_TYPE_SCALAR;
+        case 2: return TINYGLTF_TYPE_VEC2;
+        case 3: return TINYGLTF_TYPE_VEC3;
+        case 4: return TINYGLTF_TYPE_VEC4;
+        default: return -1;
+    }
+}
+
+// A view + accessor over data that is already in buffer 0 (the file itself)
+static int AddAccessor( tinygltf::Model &model, uint64_t offset, size_t count, int componentType, int type, size_t bytes )
+{
+    tinygltf::BufferView view;
+    view.buffer = 0;
+    view.byteOffset = offset;
+    view.byteLength = bytes;
+    model.bufferViews.push_back(view);
+
+    tinygltf::Accessor accessor;
+    accessor.bufferView = (int)model.bufferViews.size() - 1;
+    accessor.byteOffset = 0;
+    accessor.componentType = componentType;
+    accessor.type = type;
+    accessor.count = count;
+    model.accessors.push_back(accessor);
+    return (int)model.accessors.size() - 1;
+}
+
+static bool ReadPrimitives( const BakeFile &file, const BakeHeader *header, tinygltf::Model &model )
+{
+    if( !InRange(file, header->primitives, header->numprimitives, sizeof(BakePrimitive)) ) return false;
+    const BakePrimitive *prims = (const BakePrimitive *)(file.data + header->primitives);
+
+    if( header->numlods > 64 ) return false;
+    model.meshes.resize((size_t)header->nummeshes * (header->numlods + 1));
+    for( uint32_t i=0; i<header->numprimitives; ++i )
+    {
+        const BakePrimitive &bp = prims[i];
+        if( bp.mesh < 0 || bp.mesh >= (int32_t)header->nummeshes || bp.lod > header->numlods ) return false;
+        if( !InRange(file, bp.streams, bp.numstreams, sizeof(BakeStream)) ) return false;
+        if( !InRange(file, bp.indices, bp.indexcount, bp.indexsize) || (bp.indexsize != 2 && bp.indexsize != 4) ) return false;
+
+        tinygltf::Mesh &mesh = model.meshes[bp.mesh + (size_t)bp.lod * header->nummeshes];
+        mesh.name = GetString(file, header, bp.meshname);
+        if( bp.lod > 0 )
+        {
+            char suffix[16];
+            snprintf(suffix, sizeof(suffix), "_lod%u", bp.lod);
+            mesh.name += suffix;
+
+            tinygltf::Value::Object extras;
+            extras["lod_of"] = tinygltf::Value(bp.mesh);
+            extras["lod"] = tinygltf::Value((int)bp.lod);
+            mesh.extras = tinygltf::Value(extras);
+        }
+
+        tinygltf::Primitive prim;
+        prim.mode = TINYGLTF_MODE_TRIANGLES;
+        prim.material = bp.material;
+
+        const BakeStream *streams = (const BakeStream *)(file.data + bp.streams);
+        for( uint32_t s=0; s<bp.numstreams; ++s )
+        {
+            const BakeStream &bs = streams[s];
+            char name[sizeof(bs.name) + 1];
+            memcpy(name, bs.name, sizeof(bs.name));
+            name[sizeof(bs.name)] = 0;
+
+            const char *attribute = StreamAttributeName(name);
+            int type = AccessorTypeForComponents(bs.components);
+            if( !attribute || type < 0 ) continue;
+            if( !InRange(file, bs.data, (uint64_t)bp.vertexcount * bs.components, sizeof(float)) ) return false;
+
+            int accessor = AddAccessor(model, bs.data, bp.vertexcount, TINYGLTF_COMPONENT_TYPE_FLOAT, type,
+                                       (size_t)bp.vertexcount * bs.components * sizeof(float));
+            tinygltf::Accessor &acc = model.accessors[accessor];
+            acc.minValues.assign(bs.min, bs.min + bs.components);
+            acc.maxValues.assign(bs.max, bs.max + bs.components);
+            prim.attributes[attribute] = accessor;
+        }
+
+        prim.indices = AddAccessor(model, bp.indices, bp.indexcount,
+                                   bp.indexsize == 2 ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
+                                   TINYGLTF_TYPE_SCALAR, (size_t)bp.indexcount * bp.indexsize);
+
+        if( bp.primitive >= (int32_t)mesh.primitives.size() ) mesh.primitives.resize(bp.primitive + 1);
+        mesh.primitives[bp.primitive] = prim;
+    }
+    return true;
+}
+
+static bool ReadNodes( const BakeFile &file, const BakeHeader *header, tinygltf::Model &model )
+{
+    if( !InRange(file, header->nodes, header->numnodes, sizeof(BakeNode)) ) return false;
+    const BakeNode *nodes = (const BakeNode *)(file.data + header->nodes);
+
+    model.nodes.resize(header->numnodes);
+    for( uint32_t n=0; n<header->numnodes; ++n )
+    {
+        const BakeNode &bn = nodes[n];
+        tinygltf::Node &node = model.nodes[n];
+        if( !InRange(file, bn.children, bn.numchildren, sizeof(int32_t)) ) return false;
+
+        node.name = GetString(file, header, bn.name);
+        node.mesh = bn.mesh;
+        const int32_t *children = (const int32_t *)(file.data + bn.children);
+        node.children.assign(children, children + bn.numchildren);
+        if( bn.hasmatrix )
+        {
+            node.matrix.assign(bn.matrix, bn.matrix + 16);
+        }
+        else
+        {
+            node.translation.assign(bn.translation, bn.translation + 3);
+            node.rotation.assign(bn.rotation, bn.rotation + 4);
+            node.scale.assign(bn.scale, bn.scale + 3);
+        }
+    }
+    return true;
+}
+
+static bool ReadMaterials( const BakeFile &file, const BakeHeader *header, tinygltf::Model &model )
+{
+    if( !InRange(file, header->materials, header->nummaterials, sizeof(BakeMaterial)) ) return false;
+    const BakeMaterial *materials = (const BakeMaterial *)(file.data + header->materials);
+
+    model.materials.resize(header->nummaterials);
+    for( uint32_t m=0; m<header->nummaterials; ++m )
+    {
+        const BakeMaterial &bm = materials[m];
+        tinygltf::Material &mat = model.materials[m];
+        tinygltf::PbrMetallicRoughness &pbr = mat.pbrMetallicRoughness;
+        mat.name = GetString(file, header, bm.name);
+        mat.alphaMode = AlphaModeToString(bm.alphamode);
+        mat.alphaCutoff = bm.alphacutoff;
+        mat.doubleSided = bm.doublesided != 0;
+        pbr.baseColorFactor.assign(bm.basecolor, bm.basecolor + 4);
+        mat.emissiveFactor.assign(bm.emissive, bm.emissive + 3);
+        pbr.metallicFactor = bm.metallic;
+        pbr.roughnessFactor = bm.roughness;
+        mat.normalTexture.scale = bm.normalscale;
+        mat.occlusionTexture.strength = bm.occlusionstrength;
+        pbr.baseColorTexture.index = bm.basecolortexture;
+        pbr.metallicRoughnessTexture.index = bm.metallicroughnesstexture;
+        mat.normalTexture.index = bm.normaltexture;
+        mat.occlusionTexture.index = bm.occlusiontexture;
+        mat.emissiveTexture.index = bm.emissivetexture;
+        pbr.baseColorTexture.texCoord = bm.texcoords[0];
+        pbr.metallicRoughnessTexture.texCoord = bm.texcoords[1];
+        mat.normalTexture.texCoord = bm.texcoords[2];
+        mat.occlusionTexture.texCoord = bm.texcoords[3];
+        mat.emissiveTexture.texCoord = bm.texcoords[4];
+    }
+    return true;
+}
+
+static bool ReadImages( const BakeFile &file, const BakeHeader *header, tinygltf::Model &model )
+{
+    if( !InRange(file, header->textures, header->numtextures, sizeof(BakeTexture)) ) return false;
+    if( !InRange(file, header->samplers, header->numsamplers, sizeof(BakeSampler)) ) return false;
+    if( !InRange(file, header->images, header->numimages, sizeof(BakeImage)) ) return false;
+
+    const BakeTexture *textures = (const BakeTexture *)(file.data + header->textures);
+    model.textures.resize(header->numtextures);
+    for( uint32_t t=0; t<header->numtextures; ++t )
+    {
+        model.textures[t].name = GetString(file, header, textures[t].name);
+        model.textures[t].source = textures[t].source;
+        model.textures[t].sampler = textures[t].sampler;
+    }
+
+    const BakeSampler *samplers = (const BakeSampler *)(file.data + header->samplers);
+    model.samplers.resize(header->numsamplers);
+    for( uint32_t s=0; s<header->numsamplers; ++s )
+    {
+        tinygltf::Sampler &sampler = model.samplers[s];
+        sampler.name = GetString(file, header, samplers[s].name);
+        sampler.minFilter = samplers[s].minfilter;
+        sampler.magFilter = samplers[s].magfilter;
+        sampler.wrapS = samplers[s].wraps;
+        sampler.wrapT = samplers[s].wrapt;
+    }
+
+    // Same state StageImageData leaves them in, DecodeImages/get_image take it from here
+    const BakeImage *images = (const BakeImage *)(file.data + header->images);
+    model.images.resize(header->numimages);
+    for( uint32_t i=0; i<header->numimages; ++i )
+    {
+        const BakeImage &bi = images[i];
+        if( !InRange(file, bi.data, bi.size, 1) ) return false;
+        tinygltf::Image &image = model.images[i];
+        image.name = GetString(file, header, bi.name);
+        image.mimeType = GetString(file, header, bi.mimetype);
+        image.uri = GetString(file, header, bi.uri);
+        image.image.assign(file.data + bi.data, file.data + bi.data + bi.size);
+        image.as_is = true;
+    }
+    return true;
+}
+
+static bool ReadScenes( const BakeFile &file, const BakeHeader *header, tinygltf::Model &model )
+{
+    if( !InRange(file, header->scenes, header->numscenes, sizeof(BakeScene)) ) return false;
+    const BakeScene *scenes = (const BakeScene *)(file.data + header->scenes);
+
+    model.scenes.resize(header->numscenes);
+    for( uint32_t s=0; s<header->numscenes; ++s )
+    {
+        if( !InRange(file, scenes[s].nodes, scenes[s].numnodes, sizeof(int32_t)) ) return false;
+        const int32_t *roots = (const int32_t *)(file.data + scenes[s].nodes);
+        model.scenes[s].name = GetString(file, header, scenes[s].name);
+        model.scenes[s].nodes.assign(roots, roots + scenes[s].numnodes);
+    }
+    model.defaultScene = header->defaultscene;
+    return true;
+}
+
+static bool ReadAnimations( const BakeFile &file, const BakeHeader *header, tinygltf::Model &model )
+{
+    if( !InRange(file, header->animations, header->numanimations, sizeof(BakeAnimation)) ) return false;
+    const BakeAnimation *animations = (const BakeAnimation *)(file.data + header->animations);
+
+    model.animations.resize(header->numanimations);
+    for( uint32_t a=0; a<header->numanimations; ++a )
+    {
+        const BakeAnimation &ba = animations[a];
+        if( !InRange(file, ba.channels, ba.numchannels, sizeof(BakeChannel)) ) return false;
+        tinygltf::Animation &anim = model.animations[a];
+        anim.name = GetString(file, header, ba.name);
+
+        const BakeChannel *channels = (const BakeChannel *)(file.data + ba.channels);
+        for( uint32_t c=0; c<ba.numchannels; ++c )
+        {
+            const BakeChannel &bc = channels[c];
+            int type = AccessorTypeForComponents(bc.components);
+            if( type < 0 ) continue;
+            if( !InRange(file, bc.times, bc.numkeys, sizeof(float)) ) return false;
+            if( !InRange(file, bc.values, (uint64_t)bc.numvalues * bc.components, sizeof(float)) ) return false;
+
+            // One sampler per channel, shared samplers in the source are duplicated
+            tinygltf::AnimationSampler sampler;
+            sampler.input = AddAccessor(model, bc.times, bc.numkeys, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_SCALAR,
+                                        (size_t)bc.numkeys * sizeof(float));
+            sampler.output = AddAccessor(model, bc.values, bc.numvalues, TINYGLTF_COMPONENT_TYPE_FLOAT, type,
+                                         (size_t)bc.numvalues * bc.components * sizeof(float));
+            sampler.interpolation = GetString(file, header, bc.interpolation);
+            if( sampler.interpolation.empty() ) sampler.interpolation = "LINEAR";
+
+            if( bc.numkeys > 0 )
+            {
+                const float *times = (const float *)(file.data + bc.times);
+                model.accessors[sampler.input].minValues.assign(1, times[0]);
+                model.accessors[sampler.input].maxValues.assign(1, times[bc.numkeys - 1]);
+            }
+
+            tinygltf::AnimationChannel channel;
+            channel.sampler = (int)anim.samplers.size();
+            channel.target_node = bc.node;
+            channel.target_path = GetString(file, header, bc.path);
+            anim.samplers.push_back(sampler);
+            anim.channels.push_back(channel);
+        }
+    }
+    return true;
+}
+
+// Every file the bake was made from still has the contents it had then
+static bool CheckDependencies( const BakeFile &file, const BakeHeader *header, const char *source )
+{
+    if( header->numdependencies == 0 ) return false;
+    if( !InRange(file, header->dependencies, header->numdependencies, sizeof(BakeDependency)) ) return false;
+    const BakeDependency *deps = (const BakeDependency *)(file.data + header->dependencies);
+    for( uint32_t d=0; d<header->numdependencies; ++d )
+    {
+        uint64_t size, mtime, hash;
+        std::string path = GetDependencyPath(source, GetString(file, header, deps[d].uri));
+        if( GetSourceStamp(path.c_str(), &size, &mtime) )
+        {
+            if( size != deps[d].size ) return false;
+            if( mtime == deps[d].mtime ) continue;
+            if( !HashFile(path.c_str(), &hash) || hash != deps[d].hash ) return false;
+            continue;
+        }
+
+        // Not on disk (a bundle), read it like the parse would and hash that
+        std::vector<unsigned char> bytes;
+        std::string err;
+        if( !ReadModelFile(path.c_str(), &bytes, &err) || bytes.size() != deps[d].size ) return false;
+        if( HashBytes(FNV_OFFSET, bytes.empty() ? 0 : &bytes[0], bytes.size()) != deps[d].hash ) return false;
+    }
+    return true;
+}
+
+bool ReadMeshCache( const char *path, const char *source, tinygltf::Model &model )
+{
+    BakeStorage storage;
+    BakeFile file;
+    if( !OpenBake(path, storage, file) ) return false;
+
+    const BakeHeader *header = (const BakeHeader *)file.data;
+    bool ok = file.size >= sizeof(BakeHeader)
+           && memcmp(header->magic, BAKE_MAGIC, sizeof(header->magic)) == 0
+           && header->version == BAKE_VERSION
+           && header->headersize == sizeof(BakeHeader)
+           && header->filesize == file.size
+           && header->imagedata <= file.size;
+
+    // Tables, streams, indices and keyframes all come before imagedata, only the
+    // encoded images are read from the whole file
+    BakeFile head = { file.data, ok ? header->imagedata : 0 };
+    ok = ok && InRange(head, header->strings, header->stringsize, 1)
+            && CheckDependencies(head, header, source);
+
+    if( ok )
+    {
+        // The streams stay where they are, that part of the file becomes buffer 0
+        // in one copy. The images are copied out on their own, not held twice.
+        model = tinygltf::Model();
+        model.buffers.resize(1);
+        model.buffers[0].data.assign(head.data, head.data + head.size);
+        model.asset.version = "2.0";
+
+        ok = ReadPrimitives(head, header, model)
+          && ReadNodes(head, header, model)
+          && ReadMaterials(head, header, model)
+          && ReadImages(file, header, model)
+          && ReadScenes(head, header, model)
+          && ReadAnimations(head, header, model);
+    }
+
+    CloseBake(storage);
+    if( !ok ) model = tinygltf::Model();
+    return ok;
+}
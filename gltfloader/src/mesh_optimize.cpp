@@ -0,0 +1,184 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "mesh_optimize.h"
+#include "gltf_profile.h"
+
+float ComputeACMR( const uint32_t *indices, size_t count, size_t vertexcount, int cachesize )
+{
+    if( count < 3 ) return 0.0f;
+
+    // Each vertex remembers when it went into the cache, it is still in
+    //   the cache if less than cachesize misses happened since then.
+    std::vector<uint32_t> stamp(vertexcount, 0);
+    uint32_t misses = 0;
+    for( size_t i=0; i<count; ++i )
+    {
+        uint32_t v = indices[i];
+        if( stamp[v] == 0 || misses - stamp[v] >= (uint32_t)cachesize )
+        {
+            misses++;
+            stamp[v] = misses;
+        }
+    }
+    return (float)misses / (float)(count / 3);
+}
+
+typedef struct TipsifyState {
+    const uint32_t          *indices;
+    std::vector<uint32_t>   adjoffset;      // vertex -> first triangle in adjacency
+    std::vector<uint32_t>   adjacency;      // triangles using each vertex
+    std::vector<uint32_t>   live;           // triangles left to emit per vertex
+    std::vector<uint32_t>   cache;          // time stamp the vertex entered the cache
+    std::vector<uint32_t>   deadend;
+    std::vector<char>       emitted;
+    uint32_t                time;
+    size_t                  cursor;
+} TipsifyState;
+
+static int SkipDeadEnd( TipsifyState &state, size_t vertexcount )
+{
+    while( !state.deadend.empty() )
+    {
+        uint32_t d = state.deadend.back();
+        state.deadend.pop_back();
+        if( state.live[d] > 0 ) return (int)d;
+    }
+    for( ; state.cursor < vertexcount; ++state.cursor )
+    {
+        if( state.live[state.cursor] > 0 ) return (int)state.cursor;
+    }
+    return -1;
+}
+
+static int GetNextVertex( TipsifyState &state, const std::vector<uint32_t> &candidates, size_t vertexcount, int cachesize )
+{
+    int best = -1;
+    int bestpriority = -1;
+    for( size_t i=0; i<candidates.size(); ++i )
+    {
+        uint32_t v = candidates[i];
+        if( state.live[v] == 0 ) continue;
+
+        // Prefer vertices that will still be in the cache once their fan is done
+        int priority = 0;
+        int age = (int)(state.time - state.cache[v]);
+        if( age + 2 * (int)state.live[v] <= cachesize )
+            priority = age;
+        if( priority > bestpriority )
+        {
+            bestpriority = priority;
+            best = (int)v;
+        }
+    }
+    if( best == -1 )
+        best = SkipDeadEnd(state, vertexcount);
+    return best;
+}
+
+void OptimizeVertexCache( uint32_t *indices, size_t count, size_t vertexcount, int cachesize )
+{
+    size_t tricount = count / 3;
+    if( tricount < 2 || vertexcount == 0 ) return;
+
+    TipsifyState state;
+    state.indices = indices;
+    state.live.assign(vertexcount, 0);
+    for( size_t i=0; i<tricount * 3; ++i )
+        state.live[indices[i]]++;
+
+    state.adjoffset.assign(vertexcount + 1, 0);
+    for( size_t v=0; v<vertexcount; ++v )
+        state.adjoffset[v + 1] = state.adjoffset[v] + state.live[v];
+    state.adjacency.resize(tricount * 3);
+    std::vector<uint32_t> fill(state.adjoffset.begin(), state.adjoffset.end() - 1);
+    for( size_t t=0; t<tricount; ++t )
+    {
+        for( int c=0; c<3; ++c )
+            state.adjacency[fill[indices[t * 3 + c]]++] = (uint32_t)t;
+    }
+
+    state.cache.assign(vertexcount, 0);
+    state.emitted.assign(tricount, 0);
+    state.time = cachesize + 1;
+    state.cursor = 0;
+
+    std::vector<uint32_t> output;
+    output.reserve(tricount * 3);
+    std::vector<uint32_t> candidates;
+
+    int fan = SkipDeadEnd(state, vertexcount);
+    while( fan >= 0 )
+    {
+        candidates.clear();
+        for( uint32_t a = state.adjoffset[fan]; a < state.adjoffset[fan + 1]; ++a )
+        {
+            uint32_t t = state.adjacency[a];
+            if( state.emitted[t] ) continue;
+            for( int c=0; c<3; ++c )
+            {
+                uint32_t v = indices[t * 3 + c];
+                output.push_back(v);
+                state.deadend.push_back(v);
+                candidates.push_back(v);
+                state.live[v]--;
+                if( (int)(state.time - state.cache[v]) > cachesize )
+                {
+                    state.cache[v] = state.time;
+                    state.time++;
+                }
+            }
+            state.emitted[t] = 1;
+        }
+        fan = GetNextVertex(state, candidates, vertexcount, cachesize);
+    }
+
+    memcpy(indices, &output[0], output.size() * sizeof(uint32_t));
+}
+
+size_t OptimizeVertexFetch( MeshData &mesh )
+{
+    const uint32_t unused = 0xffffffff;
+    std::vector<uint32_t> remap(mesh.vertexcount, unused);
+    uint32_t next = 0;
+    for( size_t i=0; i<mesh.indices.size(); ++i )
+    {
+        uint32_t &v = mesh.indices[i];
+        if( remap[v] == unused )
+            remap[v] = next++;
+        v = remap[v];
+    }
+
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        MeshStream &stream = mesh.streams[s];
+        std::vector<float> data(next * stream.components);
+        for( size_t v=0; v<mesh.vertexcount; ++v )
+        {
+            if( remap[v] == unused ) continue;
+            memcpy(&data[remap[v] * stream.components], &stream.data[v * stream.components], sizeof(float) * stream.components);
+        }
+        stream.data.swap(data);
+    }
+
+    mesh.vertexcount = next;
+    return next;
+}
+
+void OptimizeMesh( MeshData &mesh, MeshOptimizeStats *stats )
+{
+    GLTF_PROFILE("GltfOptimizeMesh");
+    if( stats )
+        stats->acmrbefore = ComputeACMR(mesh.indices.empty() ? 0 : &mesh.indices[0], mesh.indices.size(), mesh.vertexcount, VERTEX_CACHE_SIZE);
+
+    if( !mesh.indices.empty() )
+    {
+        OptimizeVertexCache(&mesh.indices[0], mesh.indices.size(), mesh.vertexcount, VERTEX_CACHE_SIZE);
+        OptimizeVertexFetch(mesh);
+    }
+
+    if( stats )
+        stats->acmrafter = ComputeACMR(mesh.indices.empty() ? 0 : &mesh.indices[0], mesh.indices.size(), mesh.vertexcount, VERTEX_CACHE_SIZE);
+}
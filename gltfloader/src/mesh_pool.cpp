@@ -0,0 +1,331 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+#include <dmsdk/gamesys/components/comp_factory.h>
+
+#include "mesh_pool.h"
+
+// Only the id is kept, the instance can go away under the pool (go.delete,
+// collection unload) so it is looked up again whenever the pool touches it.
+// Ids are unique per spawn (index + generation), a stale one never resolves to
+// an object that got the index later (factory.create or another pool spawn).
+typedef struct PooledMesh {
+    dmhash_t                    id;
+    uint32_t                    index;          // Collection instance index
+    bool                        active;
+} PooledMesh;
+
+static dmGameObject::HCollection            g_collection = 0;
+static dmGameSystem::HFactoryWorld          g_factoryworld = 0;
+static dmGameSystem::HFactoryComponent      g_factory = 0;
+static uint32_t                             g_capacity = MESH_POOL_DEFAULT_CAPACITY;
+
+static dmArray<PooledMesh>                  g_meshes;
+static dmArray<uint32_t>                    g_parked;           // Free list, indices into g_meshes
+static dmArray<uint32_t>                    g_unused;           // g_meshes slots of instances that are gone
+static std::unordered_map<dmhash_t, uint32_t>   g_lookup;       // id -> index into g_meshes
+static std::unordered_map<uint32_t, uint32_t>   g_indexslots;   // instance index -> index into g_meshes
+static uint32_t                             g_active = 0;
+static uint64_t                             g_generation = 0;
+
+// dmArray never grows by itself, do it in big steps so bursts do not realloc per spawn
+static void EnsureCapacity( uint32_t extra )
+{
+    uint32_t needed = g_meshes.Size() + extra;
+    if( needed <= g_meshes.Capacity() ) return;
+
+    uint32_t capacity = g_meshes.Capacity() + g_meshes.Capacity() / 2;
+    if( capacity < needed ) capacity = needed;
+    if( g_meshes.Capacity() >= g_capacity )
+        dmLogWarning("Mesh pool grows past gltfloader.mesh_pool_capacity (%u -> %u)", g_meshes.Capacity(), capacity);
+    g_meshes.SetCapacity(capacity);
+    g_parked.SetCapacity(capacity);
+    g_unused.SetCapacity(capacity);
+}
+
+// Parked instances are disabled, they take no part in update or render
+static void PostEnable( dmhash_t id, bool enable )
+{
+    dmMessage::URL receiver;
+    dmMessage::ResetURL(&receiver);
+    receiver.m_Socket = dmGameObject::GetMessageSocket(g_collection);
+    receiver.m_Path = id;
+    dmDDF::Descriptor *descriptor = enable ? dmGameObjectDDF::Enable::m_DDFDescriptor : dmGameObjectDDF::Disable::m_DDFDescriptor;
+    dmMessage::Post(0, &receiver, descriptor->m_NameHash, 0, 0, (uintptr_t)descriptor, 0, 0, 0);
+}
+
+static dmhash_t MakeMeshId( uint32_t index )
+{
+    char id[64];
+    snprintf(id, sizeof(id), "/gltfmesh%u_%llu", index, (unsigned long long)++g_generation);
+    return dmHashString64(id);
+}
+
+// Forgets an entry whose instance is gone, its slot goes to the next spawn.
+// The entry must not be on the parked list.
+static void DropMesh( uint32_t slot )
+{
+    PooledMesh &mesh = g_meshes[slot];
+    if( mesh.active ) g_active--;
+    g_lookup.erase(mesh.id);
+    std::unordered_map<uint32_t, uint32_t>::iterator it = g_indexslots.find(mesh.index);
+    if( it != g_indexslots.end() && it->second == slot ) g_indexslots.erase(it);
+    mesh.id = 0;
+    mesh.active = false;
+    g_unused.Push(slot);
+}
+
+// The live instance of a pool entry. An entry whose instance was deleted outside
+// the pool is dropped (the collection has already released its index).
+static dmGameObject::HInstance ResolveMesh( uint32_t slot )
+{
+    dmGameObject::HInstance instance = dmGameObject::GetInstanceFromIdentifier(g_collection, g_meshes[slot].id);
+    if( instance == 0 ) DropMesh(slot);
+    return instance;
+}
+
+// The collection only hands out an index again once its instance was deleted, so
+// an entry still holding it is dead even if nothing touched it since
+static void PurgeIndex( uint32_t index )
+{
+    std::unordered_map<uint32_t, uint32_t>::iterator it = g_indexslots.find(index);
+    if( it == g_indexslots.end() ) return;
+
+    uint32_t slot = it->second;
+    if( !g_meshes[slot].active )
+    {
+        for( uint32_t i=0; i<g_parked.Size(); ++i )
+        {
+            if( g_parked[i] == slot )
+            {
+                g_parked.EraseSwap(i);
+                break;
+            }
+        }
+    }
+    DropMesh(slot);
+}
+
+static bool HasFactory()
+{
+    if( g_collection == 0 || g_factory == 0 )
+    {
+        dmLogError("Mesh pool has no mesh factory, see /factories#meshfactory in the main collection");
+        return false;
+    }
+    return true;
+}
+
+static uint32_t AcquireIndex()
+{
+    uint32_t index = dmGameObject::AcquireInstanceIndex(g_collection);
+    if( index == dmGameObject::INVALID_INSTANCE_POOL_INDEX )
+        dmLogError("Gameobject buffer is full. See `collection.max_instances` in game.project");
+    return index;
+}
+
+// Spawns on an already acquired index, the index is released again on failure
+static dmGameObject::HInstance CreatePooledMesh( uint32_t index, const dmVMath::Point3 &position, const dmVMath::Quat &rotation, const dmVMath::Vector3 &scale, bool active )
+{
+    PurgeIndex(index);
+    dmhash_t id = MakeMeshId(index);
+    dmGameObject::HPropertyContainer properties = 0;
+    dmGameObject::HInstance instance = dmGameSystem::CompFactorySpawn(g_factoryworld, g_factory, g_collection,
+                                                            index, id, position, rotation, scale, properties);
+    if( instance == 0 )
+    {
+        dmGameObject::ReleaseInstanceIndex(index, g_collection);
+        dmLogError("Failed to spawn a mesh from the mesh factory");
+        return 0;
+    }
+
+    PooledMesh mesh;
+    mesh.id = id;
+    mesh.index = index;
+    mesh.active = active;
+    uint32_t slot;
+    if( !g_unused.Empty() )
+    {
+        slot = g_unused.Back();
+        g_unused.Pop();
+        g_meshes[slot] = mesh;
+    }
+    else
+    {
+        EnsureCapacity(1);
+        slot = g_meshes.Size();
+        g_meshes.Push(mesh);
+    }
+    g_lookup[id] = slot;
+    g_indexslots[index] = slot;
+    if( !active )
+    {
+        g_parked.Push(slot);
+        PostEnable(id, false);
+    }
+    return instance;
+}
+
+void InitMeshPool( dmGameObject::HCollection collection, dmGameSystem::HFactoryWorld world,
+                   dmGameSystem::HFactoryComponent factory, dmConfigFile::HConfig config )
+{
+    g_collection = collection;
+    g_factoryworld = world;
+    g_factory = factory;
+
+    int capacity = dmConfigFile::GetInt(config, "gltfloader.mesh_pool_capacity", MESH_POOL_DEFAULT_CAPACITY);
+    int prewarm = dmConfigFile::GetInt(config, "gltfloader.mesh_pool_prewarm", 0);
+    g_capacity = capacity > 0 ? (uint32_t)capacity : 1;
+
+    g_meshes.SetCapacity(g_capacity);
+    g_parked.SetCapacity(g_capacity);
+    g_unused.SetCapacity(g_capacity);
+    g_lookup.reserve(g_capacity);
+    g_indexslots.reserve(g_capacity);
+
+    if( prewarm > 0 ) PrewarmMeshPool((uint32_t)prewarm);
+}
+
+void DestroyMeshPool()
+{
+    // The instances belong to the collection, which deletes them on unload
+    g_meshes.SetSize(0);
+    g_parked.SetSize(0);
+    g_unused.SetSize(0);
+    g_lookup.clear();
+    g_indexslots.clear();
+    g_active = 0;
+    g_collection = 0;
+    g_factoryworld = 0;
+    g_factory = 0;
+}
+
+uint32_t PrewarmMeshPool( uint32_t count )
+{
+    DM_PROFILE("GltfPrewarmMeshPool");
+    dmVMath::Point3 position(0.0f, 0.0f, 0.0f);
+    dmVMath::Quat rotation(0.0f, 0.0f, 0.0f, 1.0f);
+    dmVMath::Vector3 scale(0.0f, 0.0f, 0.0f);
+
+    if( !HasFactory() ) return g_parked.Size();
+    EnsureCapacity(count > g_parked.Size() ? count - g_parked.Size() : 0);
+    while( g_parked.Size() < count )
+    {
+        uint32_t index = AcquireIndex();
+        if( index == dmGameObject::INVALID_INSTANCE_POOL_INDEX ) break;
+        if( !CreatePooledMesh(index, position, rotation, scale, false) ) break;
+    }
+    return g_parked.Size();
+}
+
+// Returns 0 once the free list has no live instance left
+static dmGameObject::HInstance SpawnParked( const dmVMath::Point3 &position, const dmVMath::Quat &rotation, const dmVMath::Vector3 &scale )
+{
+    while( !g_parked.Empty() )
+    {
+        uint32_t slot = g_parked.Back();
+        g_parked.Pop();
+        dmGameObject::HInstance instance = ResolveMesh(slot);
+        if( instance == 0 ) continue;
+
+        PooledMesh &mesh = g_meshes[slot];
+        dmGameObject::SetPosition(instance, position);
+        dmGameObject::SetRotation(instance, rotation);
+        dmGameObject::SetScale(instance, scale);
+        PostEnable(mesh.id, true);
+        mesh.active = true;
+        g_active++;
+        return instance;
+    }
+    return 0;
+}
+
+dmGameObject::HInstance SpawnPooledMesh( const dmVMath::Point3 &position, const dmVMath::Quat &rotation, const dmVMath::Vector3 &scale )
+{
+    DM_PROFILE("GltfSpawn");
+    dmGameObject::HInstance parked = SpawnParked(position, rotation, scale);
+    if( parked ) return parked;
+
+    if( !HasFactory() ) return 0;
+    uint32_t index = AcquireIndex();
+    if( index == dmGameObject::INVALID_INSTANCE_POOL_INDEX ) return 0;
+    dmGameObject::HInstance instance = CreatePooledMesh(index, position, rotation, scale, true);
+    if( instance ) g_active++;
+    return instance;
+}
+
+uint32_t AcquireMeshIndices( uint32_t count, std::vector<uint32_t> &indices )
+{
+    if( !HasFactory() ) return 0;
+
+    // Parked instances need no index, only reserve for the rest
+    uint32_t parked = g_parked.Size();
+    uint32_t needed = count > parked ? count - parked : 0;
+    EnsureCapacity(needed);
+    g_lookup.reserve(g_meshes.Size() + needed);
+    g_indexslots.reserve(g_meshes.Size() + needed);
+
+    indices.reserve(indices.size() + needed);
+    for( uint32_t i=0; i<needed; ++i )
+    {
+        uint32_t index = AcquireIndex();
+        if( index == dmGameObject::INVALID_INSTANCE_POOL_INDEX ) break;
+        indices.push_back(index);
+    }
+    return (uint32_t)indices.size();
+}
+
+void ReleaseMeshIndices( const std::vector<uint32_t> &indices, size_t first )
+{
+    if( g_collection == 0 ) return;
+    for( size_t i=first; i<indices.size(); ++i )
+        dmGameObject::ReleaseInstanceIndex(indices[i], g_collection);
+}
+
+dmGameObject::HInstance SpawnPooledMeshReserved( const std::vector<uint32_t> &indices, size_t *next,
+                                                 const dmVMath::Point3 &position, const dmVMath::Quat &rotation, const dmVMath::Vector3 &scale )
+{
+    DM_PROFILE("GltfSpawn");
+    dmGameObject::HInstance parked = SpawnParked(position, rotation, scale);
+    if( parked ) return parked;
+
+    if( *next >= indices.size() )
+        return SpawnPooledMesh(position, rotation, scale);
+
+    uint32_t index = indices[(*next)++];
+    dmGameObject::HInstance instance = CreatePooledMesh(index, position, rotation, scale, true);
+    if( instance ) g_active++;
+    return instance;
+}
+
+bool DespawnPooledMesh( dmhash_t id )
+{
+    std::unordered_map<dmhash_t, uint32_t>::iterator it = g_lookup.find(id);
+    if( it == g_lookup.end() ) return false;
+
+    uint32_t slot = it->second;
+    if( !g_meshes[slot].active ) return false;
+    if( ResolveMesh(slot) == 0 ) return false;
+
+    PooledMesh &mesh = g_meshes[slot];
+    PostEnable(mesh.id, false);
+    mesh.active = false;
+    g_parked.Push(slot);
+    g_active--;
+    return true;
+}
+
+uint32_t GetMeshPoolActiveCount()
+{
+    return g_active;
+}
+
+uint32_t GetMeshPoolParkedCount()
+{
+    return g_parked.Size();
+}
@@ -0,0 +1,396 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+
+#include "mesh_simplify.h"
+#include "mesh_optimize.h"
+#include "gltf_profile.h"
+
+// Symmetric 4x4 plane quadric, stored as the 10 unique values
+typedef struct Quadric {
+    double      a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+} Quadric;
+
+static void QuadricAdd( Quadric &q, const Quadric &o )
+{
+    q.a2 += o.a2; q.ab += o.ab; q.ac += o.ac; q.ad += o.ad;
+    q.b2 += o.b2; q.bc += o.bc; q.bd += o.bd;
+    q.c2 += o.c2; q.cd += o.cd; q.d2 += o.d2;
+}
+
+static double QuadricError( const Quadric &q, const float *p )
+{
+    double x = p[0], y = p[1], z = p[2];
+    return q.a2*x*x + 2*q.ab*x*y + 2*q.ac*x*z + 2*q.ad*x
+         + q.b2*y*y + 2*q.bc*y*z + 2*q.bd*y
+         + q.c2*z*z + 2*q.cd*z
+         + q.d2;
+}
+
+static void Cross( const float *a, const float *b, const float *c, double *n )
+{
+    double e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    double e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+    n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+    n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+// Attribute differences are weighted against the geometric error as if a difference
+// of 1 moved the surface by 10% of the mesh size
+#define SIMPLIFY_ATTRIBUTE_WEIGHT   0.01
+
+typedef struct Collapse {
+    double      cost;
+    uint32_t    from;           // Position groups
+    uint32_t    to;
+    uint32_t    version;        // version of 'from' when the cost was computed
+    bool operator<( const Collapse &o ) const { return cost > o.cost; }   // min heap
+} Collapse;
+
+// The collapse works on position groups: all the split vertices (UV/normal seams,
+// flat shading) of a position move as one. Their attributes stay as they are,
+// each vertex of the collapsed group is remapped to a vertex of the target group.
+typedef struct SimplifyState {
+    const float                             *pos;           // Per group xyz
+    const uint32_t                          *posid;         // Vertex -> group
+    std::vector<uint32_t>                   indices;        // Vertex indices
+    std::vector<char>                       tridead;
+    std::vector< std::vector<uint32_t> >    grouptris;
+    std::vector< std::vector<uint32_t> >    groupverts;
+    std::vector<Quadric>                    quadrics;
+    std::vector<uint32_t>                   version;
+    std::vector<char>                       locked;
+    std::vector<char>                       dead;
+    std::priority_queue<Collapse>           heap;
+
+    std::vector<float>                      attributes;     // Every stream but position, packed per vertex
+    int                                     attributecount;
+    std::vector<double>                     area;           // Surface each vertex stands for
+    double                                  attributeweight;
+    std::vector<uint32_t>                   remap;          // Scratch, vertex of 'from' -> vertex of 'to'
+} SimplifyState;
+
+static double AttributeDistance( const SimplifyState &state, uint32_t a, uint32_t b )
+{
+    const float *x = &state.attributes[a * state.attributecount];
+    const float *y = &state.attributes[b * state.attributecount];
+    double d = 0.0;
+    for( int i=0; i<state.attributecount; ++i )
+        d += (double)(x[i] - y[i]) * (x[i] - y[i]);
+    return d;
+}
+
+// Picks the vertex of 'to' each vertex of 'from' turns into: the one it shares a
+// collapsing triangle with (same side of a seam), else the closest attributes.
+// Returns the attribute error of the remap.
+static double RemapGroup( SimplifyState &state, uint32_t from, uint32_t to )
+{
+    const std::vector<uint32_t> &verts = state.groupverts[from];
+    const std::vector<uint32_t> &targets = state.groupverts[to];
+    for( size_t i=0; i<verts.size(); ++i )
+        state.remap[verts[i]] = ~0u;
+
+    const std::vector<uint32_t> &tris = state.grouptris[from];
+    for( size_t i=0; i<tris.size(); ++i )
+    {
+        uint32_t t = tris[i];
+        if( state.tridead[t] ) continue;
+        const uint32_t *tri = &state.indices[t * 3];
+        uint32_t a = ~0u, b = ~0u;
+        for( int c=0; c<3; ++c )
+        {
+            if( state.posid[tri[c]] == from ) a = tri[c];
+            else if( state.posid[tri[c]] == to ) b = tri[c];
+        }
+        if( a != ~0u && b != ~0u && state.remap[a] == ~0u )
+            state.remap[a] = b;
+    }
+
+    double error = 0.0;
+    for( size_t i=0; i<verts.size(); ++i )
+    {
+        uint32_t a = verts[i];
+        if( state.remap[a] == ~0u )
+        {
+            double best = 0.0;
+            for( size_t j=0; j<targets.size(); ++j )
+            {
+                double d = AttributeDistance(state, a, targets[j]);
+                if( j == 0 || d < best )
+                {
+                    best = d;
+                    state.remap[a] = targets[j];
+                }
+            }
+        }
+        if( state.remap[a] != ~0u )
+            error += AttributeDistance(state, a, state.remap[a]) * state.area[a];
+    }
+    return error * state.attributeweight;
+}
+
+static double CollapseCost( SimplifyState &state, uint32_t from, uint32_t to )
+{
+    Quadric q = state.quadrics[from];
+    QuadricAdd(q, state.quadrics[to]);
+    return QuadricError(q, state.pos + to * 3) + RemapGroup(state, from, to);
+}
+
+static void PushCollapse( SimplifyState &state, uint32_t from, uint32_t to )
+{
+    if( from == to || state.locked[from] || state.dead[from] || state.dead[to] ) return;
+    Collapse c;
+    c.cost = CollapseCost(state, from, to);
+    c.from = from;
+    c.to = to;
+    c.version = state.version[from];
+    state.heap.push(c);
+}
+
+static void PushGroupCollapses( SimplifyState &state, uint32_t g )
+{
+    const std::vector<uint32_t> &tris = state.grouptris[g];
+    for( size_t i=0; i<tris.size(); ++i )
+    {
+        uint32_t t = tris[i];
+        if( state.tridead[t] ) continue;
+        for( int c=0; c<3; ++c )
+        {
+            uint32_t n = state.posid[state.indices[t * 3 + c]];
+            if( n == g ) continue;
+            PushCollapse(state, g, n);
+            PushCollapse(state, n, g);
+        }
+    }
+}
+
+static bool HasGroup( const SimplifyState &state, const uint32_t *tri, uint32_t g )
+{
+    return state.posid[tri[0]] == g || state.posid[tri[1]] == g || state.posid[tri[2]] == g;
+}
+
+// Moving 'from' onto 'to' must not flip any of the triangles that survive
+static bool CollapseFlips( const SimplifyState &state, uint32_t from, uint32_t to )
+{
+    const std::vector<uint32_t> &tris = state.grouptris[from];
+    const float *target = state.pos + to * 3;
+    for( size_t i=0; i<tris.size(); ++i )
+    {
+        uint32_t t = tris[i];
+        if( state.tridead[t] ) continue;
+        const uint32_t *tri = &state.indices[t * 3];
+        if( HasGroup(state, tri, to) ) continue;
+
+        const float *p[3];
+        const float *q[3];
+        for( int c=0; c<3; ++c )
+        {
+            uint32_t g = state.posid[tri[c]];
+            p[c] = state.pos + g * 3;
+            q[c] = (g == from) ? target : p[c];
+        }
+        double n0[3], n1[3];
+        Cross(p[0], p[1], p[2], n0);
+        Cross(q[0], q[1], q[2], n1);
+        if( n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0 )
+            return true;
+    }
+    return false;
+}
+
+size_t SimplifyMesh( const MeshData &in, float ratio, MeshData &out )
+{
+    GLTF_PROFILE("GltfSimplifyMesh");
+    out = in;
+    const MeshStream *positions = FindMeshStream(in, "position");
+    size_t tricount = in.indices.size() / 3;
+    size_t target = (size_t)(tricount * std::max(0.0f, std::min(1.0f, ratio)));
+    if( positions == 0 || positions->components < 3 || target >= tricount )
+        return tricount;
+
+    // Weld by position, the error metric and the topology work on the groups
+    size_t vertexcount = in.vertexcount;
+    std::unordered_map<std::string, uint32_t> posgroups;
+    std::vector<uint32_t> posid(vertexcount);
+    std::vector<float> pos;
+    SimplifyState state;
+    for( size_t v=0; v<vertexcount; ++v )
+    {
+        const float *p = &positions->data[v * positions->components];
+        std::string key((const char *)p, sizeof(float) * 3);
+        std::unordered_map<std::string, uint32_t>::iterator it = posgroups.find(key);
+        if( it == posgroups.end() )
+        {
+            posid[v] = (uint32_t)(pos.size() / 3);
+            posgroups[key] = posid[v];
+            pos.insert(pos.end(), p, p + 3);
+            state.groupverts.push_back(std::vector<uint32_t>());
+        }
+        else
+            posid[v] = it->second;
+        state.groupverts[posid[v]].push_back((uint32_t)v);
+    }
+    size_t groupcount = pos.size() / 3;
+
+    state.pos = &pos[0];
+    state.posid = &posid[0];
+    state.indices.assign(in.indices.begin(), in.indices.begin() + tricount * 3);
+    state.tridead.assign(tricount, 0);
+    state.grouptris.resize(groupcount);
+    state.quadrics.resize(groupcount);
+    memset(&state.quadrics[0], 0, sizeof(Quadric) * groupcount);
+    state.version.assign(groupcount, 0);
+    state.locked.assign(groupcount, 0);
+    state.dead.assign(groupcount, 0);
+    state.remap.assign(vertexcount, ~0u);
+    state.area.assign(vertexcount, 0.0);
+
+    // Normals, texcoords, colors ... packed per vertex for the seam error
+    state.attributecount = 0;
+    for( size_t s=0; s<in.streams.size(); ++s )
+        if( &in.streams[s] != positions ) state.attributecount += in.streams[s].components;
+    state.attributes.resize(vertexcount * state.attributecount);
+    for( size_t v=0; v<vertexcount; ++v )
+    {
+        float *dst = &state.attributes[v * state.attributecount];
+        for( size_t s=0; s<in.streams.size(); ++s )
+        {
+            const MeshStream &stream = in.streams[s];
+            if( &stream == positions ) continue;
+            memcpy(dst, &stream.data[v * stream.components], sizeof(float) * stream.components);
+            dst += stream.components;
+        }
+    }
+
+    float minp[3] = { pos[0], pos[1], pos[2] }, maxp[3] = { pos[0], pos[1], pos[2] };
+    for( size_t g=0; g<groupcount; ++g )
+    {
+        for( int c=0; c<3; ++c )
+        {
+            minp[c] = std::min(minp[c], pos[g * 3 + c]);
+            maxp[c] = std::max(maxp[c], pos[g * 3 + c]);
+        }
+    }
+    double extent2 = 0.0;
+    for( int c=0; c<3; ++c )
+        extent2 += (double)(maxp[c] - minp[c]) * (maxp[c] - minp[c]);
+    state.attributeweight = SIMPLIFY_ATTRIBUTE_WEIGHT * extent2;
+
+    // Open borders (edges with a single triangle, by position) are locked
+    std::unordered_map<uint64_t, uint32_t> edgeuse;
+    for( size_t t=0; t<tricount; ++t )
+    {
+        for( int c=0; c<3; ++c )
+        {
+            uint64_t a = posid[state.indices[t * 3 + c]];
+            uint64_t b = posid[state.indices[t * 3 + (c + 1) % 3]];
+            edgeuse[(std::min(a, b) << 32) | std::max(a, b)]++;
+        }
+    }
+
+    for( size_t t=0; t<tricount; ++t )
+    {
+        const uint32_t *tri = &state.indices[t * 3];
+        uint32_t g[3] = { posid[tri[0]], posid[tri[1]], posid[tri[2]] };
+        double n[3];
+        Cross(&pos[g[0] * 3], &pos[g[1] * 3], &pos[g[2] * 3], n);
+        double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if( len > 0.0 )
+        {
+            // Area weighted plane quadric
+            double area = len * 0.5;
+            double a = n[0] / len, b = n[1] / len, c = n[2] / len;
+            double d = -(a * pos[g[0] * 3] + b * pos[g[0] * 3 + 1] + c * pos[g[0] * 3 + 2]);
+            Quadric q = { a*a*area, a*b*area, a*c*area, a*d*area, b*b*area, b*c*area, b*d*area, c*c*area, c*d*area, d*d*area };
+            for( int k=0; k<3; ++k )
+            {
+                QuadricAdd(state.quadrics[g[k]], q);
+                state.area[tri[k]] += area / 3.0;
+            }
+        }
+
+        for( int k=0; k<3; ++k )
+        {
+            // A degenerate triangle can name a group twice, it is listed once
+            if( k == 0 || (g[k] != g[0] && (k == 1 || g[k] != g[1])) )
+                state.grouptris[g[k]].push_back((uint32_t)t);
+            uint64_t a = g[k];
+            uint64_t b = g[(k + 1) % 3];
+            if( edgeuse[(std::min(a, b) << 32) | std::max(a, b)] == 1 )
+            {
+                state.locked[a] = 1;
+                state.locked[b] = 1;
+            }
+        }
+    }
+
+    for( size_t g=0; g<groupcount; ++g )
+        PushGroupCollapses(state, (uint32_t)g);
+
+    size_t live = tricount;
+    while( live > target && !state.heap.empty() )
+    {
+        Collapse c = state.heap.top();
+        state.heap.pop();
+        if( state.dead[c.from] || state.dead[c.to] || c.version != state.version[c.from] )
+            continue;
+
+        // Neighbouring collapses change the cost, an outdated entry goes back in
+        double cost = CollapseCost(state, c.from, c.to);
+        if( cost > c.cost * 1.0001 + 1e-12 )
+        {
+            c.cost = cost;
+            state.heap.push(c);
+            continue;
+        }
+        if( CollapseFlips(state, c.from, c.to) )
+            continue;
+
+        // Retarget every triangle of 'from', the ones shared with 'to' collapse away.
+        // CollapseCost left the vertex remap for this pair in state.remap.
+        std::vector<uint32_t> &fromtris = state.grouptris[c.from];
+        std::vector<uint32_t> &totris = state.grouptris[c.to];
+        for( size_t i=0; i<fromtris.size(); ++i )
+        {
+            uint32_t t = fromtris[i];
+            if( state.tridead[t] ) continue;
+            uint32_t *tri = &state.indices[t * 3];
+            if( HasGroup(state, tri, c.to) )
+            {
+                state.tridead[t] = 1;
+                live--;
+                continue;
+            }
+            for( int k=0; k<3; ++k )
+            {
+                if( posid[tri[k]] == c.from ) tri[k] = state.remap[tri[k]];
+            }
+            totris.push_back(t);
+        }
+        fromtris.clear();
+
+        std::vector<uint32_t> &fromverts = state.groupverts[c.from];
+        for( size_t i=0; i<fromverts.size(); ++i )
+            state.area[state.remap[fromverts[i]]] += state.area[fromverts[i]];
+        fromverts.clear();
+
+        state.dead[c.from] = 1;
+        QuadricAdd(state.quadrics[c.to], state.quadrics[c.from]);
+        state.version[c.to]++;
+        PushGroupCollapses(state, c.to);
+    }
+
+    out.indices.clear();
+    for( size_t t=0; t<tricount; ++t )
+    {
+        if( state.tridead[t] ) continue;
+        out.indices.insert(out.indices.end(), &state.indices[t * 3], &state.indices[t * 3] + 3);
+    }
+    OptimizeVertexFetch(out);
+    return out.indices.size() / 3;
+}
@@ -0,0 +1,539 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "model_describe.h"
+#include "gltf_profile.h"
+
+static const char *ModeName( int mode )
+{
+    switch( mode )
+    {
+        case TINYGLTF_MODE_POINTS:          return "POINTS";
+        case TINYGLTF_MODE_LINE:            return "LINES";
+        case TINYGLTF_MODE_LINE_LOOP:       return "LINE_LOOP";
+        case TINYGLTF_MODE_LINE_STRIP:      return "LINE_STRIP";
+        case -1:
+        case TINYGLTF_MODE_TRIANGLES:       return "TRIANGLES";
+        case TINYGLTF_MODE_TRIANGLE_STRIP:  return "TRIANGLE_STRIP";
+        case TINYGLTF_MODE_TRIANGLE_FAN:    return "TRIANGLE_FAN";
+    }
+    return "UNKNOWN";
+}
+
+static const char *TypeName( int type )
+{
+    switch( type )
+    {
+        case TINYGLTF_TYPE_SCALAR:  return "SCALAR";
+        case TINYGLTF_TYPE_VEC2:    return "VEC2";
+        case TINYGLTF_TYPE_VEC3:    return "VEC3";
+        case TINYGLTF_TYPE_VEC4:    return "VEC4";
+        case TINYGLTF_TYPE_MAT2:    return "MAT2";
+        case TINYGLTF_TYPE_MAT3:    return "MAT3";
+        case TINYGLTF_TYPE_MAT4:    return "MAT4";
+    }
+    return "UNKNOWN";
+}
+
+static const char *ComponentTypeName( int type )
+{
+    switch( type )
+    {
+        case TINYGLTF_COMPONENT_TYPE_BYTE:              return "BYTE";
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:     return "UNSIGNED_BYTE";
+        case TINYGLTF_COMPONENT_TYPE_SHORT:             return "SHORT";
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:    return "UNSIGNED_SHORT";
+        case TINYGLTF_COMPONENT_TYPE_INT:               return "INT";
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:      return "UNSIGNED_INT";
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:             return "FLOAT";
+        case TINYGLTF_COMPONENT_TYPE_DOUBLE:            return "DOUBLE";
+    }
+    return "UNKNOWN";
+}
+
+// Small wrappers so the walk below reads like the document it produces
+
+static void Begin( const DescribeWriter *w, const char *key, bool array )  { w->begin(w->ctx, key, array); }
+static void End( const DescribeWriter *w, bool array )                     { w->end(w->ctx, array); }
+static void Number( const DescribeWriter *w, const char *key, double v )   { w->number(w->ctx, key, v); }
+static void Boolean( const DescribeWriter *w, const char *key, bool v )    { w->boolean(w->ctx, key, v); }
+
+static void String( const DescribeWriter *w, const char *key, const std::string &s )
+{
+    if( !s.empty() ) w->string(w->ctx, key, s.c_str());
+}
+
+// glTF indices, -1 (not set) is left out
+static void Index( const DescribeWriter *w, const char *key, int index )
+{
+    if( index >= 0 ) w->number(w->ctx, key, index);
+}
+
+// Data uris can be megabytes, those only say that the data is embedded
+static void Uri( const DescribeWriter *w, const std::string &uri )
+{
+    if( uri.compare(0, 5, "data:") == 0 ) Boolean(w, "embedded", true);
+    else String(w, "uri", uri);
+}
+
+template <typename T>
+static void Numbers( const DescribeWriter *w, const char *key, const std::vector<T> &values )
+{
+    if( values.empty() ) return;
+    Begin(w, key, true);
+    for( size_t i=0; i<values.size(); ++i )
+        Number(w, 0, values[i]);
+    End(w, true);
+}
+
+static void Value( const DescribeWriter *w, const char *key, const tinygltf::Value &value )
+{
+    if( value.IsBool() ) Boolean(w, key, value.Get<bool>());
+    else if( value.IsNumber() ) Number(w, key, value.GetNumberAsDouble());
+    else if( value.IsString() ) w->string(w->ctx, key, value.Get<std::string>().c_str());
+    else if( value.IsBinary() ) Number(w, key, value.Get<std::vector<unsigned char> >().size());
+    else if( value.IsArray() )
+    {
+        const tinygltf::Value::Array &array = value.Get<tinygltf::Value::Array>();
+        Begin(w, key, true);
+        for( size_t i=0; i<array.size(); ++i )
+            Value(w, 0, array[i]);
+        End(w, true);
+    }
+    else if( value.IsObject() )
+    {
+        const tinygltf::Value::Object &object = value.Get<tinygltf::Value::Object>();
+        Begin(w, key, false);
+        for( tinygltf::Value::Object::const_iterator it = object.begin(); it != object.end(); ++it )
+            Value(w, it->first.c_str(), it->second);
+        End(w, false);
+    }
+}
+
+static void Extras( const DescribeWriter *w, const tinygltf::Value &extras )
+{
+    if( extras.Type() != tinygltf::NULL_TYPE ) Value(w, "extras", extras);
+}
+
+static void TextureRef( const DescribeWriter *w, const char *key, int index, int texcoord )
+{
+    if( index < 0 ) return;
+    Begin(w, key, false);
+    Number(w, "index", index);
+    Number(w, "texCoord", texcoord);
+    End(w, false);
+}
+
+static void DescribeNodes( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "nodes", true);
+    for( size_t i=0; i<model.nodes.size(); ++i )
+    {
+        const tinygltf::Node &node = model.nodes[i];
+        Begin(w, 0, false);
+        String(w, "name", node.name);
+        Index(w, "mesh", node.mesh);
+        Index(w, "skin", node.skin);
+        Index(w, "camera", node.camera);
+        Numbers(w, "children", node.children);
+        Numbers(w, "translation", node.translation);
+        Numbers(w, "rotation", node.rotation);
+        Numbers(w, "scale", node.scale);
+        Numbers(w, "matrix", node.matrix);
+        Numbers(w, "weights", node.weights);
+        Extras(w, node.extras);
+        End(w, false);
+    }
+    End(w, true);
+}
+
+static void DescribeMeshes( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "meshes", true);
+    for( size_t i=0; i<model.meshes.size(); ++i )
+    {
+        const tinygltf::Mesh &mesh = model.meshes[i];
+        Begin(w, 0, false);
+        String(w, "name", mesh.name);
+        Numbers(w, "weights", mesh.weights);
+        Begin(w, "primitives", true);
+        for( size_t p=0; p<mesh.primitives.size(); ++p )
+        {
+            const tinygltf::Primitive &prim = mesh.primitives[p];
+            Begin(w, 0, false);
+            w->string(w->ctx, "mode", ModeName(prim.mode));
+            Index(w, "material", prim.material);
+            Index(w, "indices", prim.indices);
+            Begin(w, "attributes", false);
+            for( std::map<std::string, int>::const_iterator it = prim.attributes.begin(); it != prim.attributes.end(); ++it )
+                Number(w, it->first.c_str(), it->second);
+            End(w, false);
+            if( !prim.targets.empty() ) Number(w, "targets", prim.targets.size());
+            Extras(w, prim.extras);
+            End(w, false);
+        }
+        End(w, true);
+        Extras(w, mesh.extras);
+        End(w, false);
+    }
+    End(w, true);
+}
+
+static void DescribeAccessors( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "accessors", true);
+    for( size_t i=0; i<model.accessors.size(); ++i )
+    {
+        const tinygltf::Accessor &accessor = model.accessors[i];
+        Begin(w, 0, false);
+        String(w, "name", accessor.name);
+        Index(w, "bufferView", accessor.bufferView);
+        Number(w, "byteOffset", accessor.byteOffset);
+        w->string(w->ctx, "componentType", ComponentTypeName(accessor.componentType));
+        w->string(w->ctx, "type", TypeName(accessor.type));
+        Number(w, "count", accessor.count);
+        if( accessor.normalized ) Boolean(w, "normalized", true);
+        Numbers(w, "min", accessor.minValues);
+        Numbers(w, "max", accessor.maxValues);
+        if( accessor.sparse.isSparse ) Number(w, "sparse", accessor.sparse.count);
+        End(w, false);
+    }
+    End(w, true);
+}
+
+static void DescribeBuffers( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "bufferViews", true);
+    for( size_t i=0; i<model.bufferViews.size(); ++i )
+    {
+        const tinygltf::BufferView &view = model.bufferViews[i];
+        Begin(w, 0, false);
+        String(w, "name", view.name);
+        Number(w, "buffer", view.buffer);
+        Number(w, "byteOffset", view.byteOffset);
+        Number(w, "byteLength", view.byteLength);
+        if( view.byteStride ) Number(w, "byteStride", view.byteStride);
+        if( view.target ) Number(w, "target", view.target);
+        End(w, false);
+    }
+    End(w, true);
+
+    Begin(w, "buffers", true);
+    for( size_t i=0; i<model.buffers.size(); ++i )
+    {
+        const tinygltf::Buffer &buffer = model.buffers[i];
+        Begin(w, 0, false);
+        String(w, "name", buffer.name);
+        Uri(w, buffer.uri);
+        Number(w, "byteLength", buffer.data.size());
+        End(w, false);
+    }
+    End(w, true);
+}
+
+static void DescribeMaterials( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "materials", true);
+    for( size_t i=0; i<model.materials.size(); ++i )
+    {
+        const tinygltf::Material &material = model.materials[i];
+        const tinygltf::PbrMetallicRoughness &pbr = material.pbrMetallicRoughness;
+        Begin(w, 0, false);
+        String(w, "name", material.name);
+        String(w, "alphaMode", material.alphaMode);
+        Number(w, "alphaCutoff", material.alphaCutoff);
+        Boolean(w, "doubleSided", material.doubleSided);
+        Numbers(w, "baseColorFactor", pbr.baseColorFactor);
+        Number(w, "metallicFactor", pbr.metallicFactor);
+        Number(w, "roughnessFactor", pbr.roughnessFactor);
+        Numbers(w, "emissiveFactor", material.emissiveFactor);
+        TextureRef(w, "baseColorTexture", pbr.baseColorTexture.index, pbr.baseColorTexture.texCoord);
+        TextureRef(w, "metallicRoughnessTexture", pbr.metallicRoughnessTexture.index, pbr.metallicRoughnessTexture.texCoord);
+        TextureRef(w, "normalTexture", material.normalTexture.index, material.normalTexture.texCoord);
+        TextureRef(w, "occlusionTexture", material.occlusionTexture.index, material.occlusionTexture.texCoord);
+        TextureRef(w, "emissiveTexture", material.emissiveTexture.index, material.emissiveTexture.texCoord);
+        Extras(w, material.extras);
+        End(w, false);
+    }
+    End(w, true);
+
+    Begin(w, "textures", true);
+    for( size_t i=0; i<model.textures.size(); ++i )
+    {
+        Begin(w, 0, false);
+        String(w, "name", model.textures[i].name);
+        Index(w, "sampler", model.textures[i].sampler);
+        Index(w, "source", model.textures[i].source);
+        End(w, false);
+    }
+    End(w, true);
+
+    Begin(w, "images", true);
+    for( size_t i=0; i<model.images.size(); ++i )
+    {
+        const tinygltf::Image &image = model.images[i];
+        Begin(w, 0, false);
+        String(w, "name", image.name);
+        Uri(w, image.uri);
+        String(w, "mimeType", image.mimeType);
+        Index(w, "bufferView", image.bufferView);
+        Index(w, "width", image.width);
+        Index(w, "height", image.height);
+        Index(w, "component", image.component);
+        Boolean(w, "decoded", !image.as_is && !image.image.empty());
+        Number(w, "bytes", image.image.size());
+        End(w, false);
+    }
+    End(w, true);
+
+    Begin(w, "samplers", true);
+    for( size_t i=0; i<model.samplers.size(); ++i )
+    {
+        const tinygltf::Sampler &sampler = model.samplers[i];
+        Begin(w, 0, false);
+        String(w, "name", sampler.name);
+        Index(w, "magFilter", sampler.magFilter);
+        Index(w, "minFilter", sampler.minFilter);
+        Number(w, "wrapS", sampler.wrapS);
+        Number(w, "wrapT", sampler.wrapT);
+        End(w, false);
+    }
+    End(w, true);
+}
+
+static void DescribeAnimations( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "animations", true);
+    for( size_t i=0; i<model.animations.size(); ++i )
+    {
+        const tinygltf::Animation &animation = model.animations[i];
+        Begin(w, 0, false);
+        String(w, "name", animation.name);
+        Begin(w, "channels", true);
+        for( size_t c=0; c<animation.channels.size(); ++c )
+        {
+            const tinygltf::AnimationChannel &channel = animation.channels[c];
+            Begin(w, 0, false);
+            Number(w, "sampler", channel.sampler);
+            Index(w, "node", channel.target_node);
+            String(w, "path", channel.target_path);
+            End(w, false);
+        }
+        End(w, true);
+        Begin(w, "samplers", true);
+        for( size_t s=0; s<animation.samplers.size(); ++s )
+        {
+            const tinygltf::AnimationSampler &sampler = animation.samplers[s];
+            Begin(w, 0, false);
+            Number(w, "input", sampler.input);
+            Number(w, "output", sampler.output);
+            String(w, "interpolation", sampler.interpolation);
+            if( sampler.input >= 0 && sampler.input < (int)model.accessors.size() )
+                Number(w, "keys", model.accessors[sampler.input].count);
+            End(w, false);
+        }
+        End(w, true);
+        End(w, false);
+    }
+    End(w, true);
+
+    Begin(w, "skins", true);
+    for( size_t i=0; i<model.skins.size(); ++i )
+    {
+        const tinygltf::Skin &skin = model.skins[i];
+        Begin(w, 0, false);
+        String(w, "name", skin.name);
+        Index(w, "skeleton", skin.skeleton);
+        Index(w, "inverseBindMatrices", skin.inverseBindMatrices);
+        Numbers(w, "joints", skin.joints);
+        End(w, false);
+    }
+    End(w, true);
+}
+
+static void DescribeCameras( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    Begin(w, "cameras", true);
+    for( size_t i=0; i<model.cameras.size(); ++i )
+    {
+        const tinygltf::Camera &camera = model.cameras[i];
+        Begin(w, 0, false);
+        String(w, "name", camera.name);
+        String(w, "type", camera.type);
+        if( camera.type == "perspective" )
+        {
+            Number(w, "yfov", camera.perspective.yfov);
+            Number(w, "aspectRatio", camera.perspective.aspectRatio);
+            Number(w, "znear", camera.perspective.znear);
+            Number(w, "zfar", camera.perspective.zfar);
+        }
+        else
+        {
+            Number(w, "xmag", camera.orthographic.xmag);
+            Number(w, "ymag", camera.orthographic.ymag);
+            Number(w, "znear", camera.orthographic.znear);
+            Number(w, "zfar", camera.orthographic.zfar);
+        }
+        End(w, false);
+    }
+    End(w, true);
+
+    Begin(w, "lights", true);
+    for( size_t i=0; i<model.lights.size(); ++i )
+    {
+        const tinygltf::Light &light = model.lights[i];
+        Begin(w, 0, false);
+        String(w, "name", light.name);
+        String(w, "type", light.type);
+        Numbers(w, "color", light.color);
+        Number(w, "intensity", light.intensity);
+        if( light.range > 0.0 ) Number(w, "range", light.range);
+        End(w, false);
+    }
+    End(w, true);
+}
+
+void DescribeModel( const tinygltf::Model &model, const DescribeWriter *w )
+{
+    GLTF_PROFILE("GltfDescribe");
+    Begin(w, 0, false);
+
+    Begin(w, "asset", false);
+    String(w, "version", model.asset.version);
+    String(w, "minVersion", model.asset.minVersion);
+    String(w, "generator", model.asset.generator);
+    String(w, "copyright", model.asset.copyright);
+    End(w, false);
+
+    Index(w, "scene", model.defaultScene);
+    if( !model.extensionsUsed.empty() )
+    {
+        Begin(w, "extensionsUsed", true);
+        for( size_t i=0; i<model.extensionsUsed.size(); ++i )
+            w->string(w->ctx, 0, model.extensionsUsed[i].c_str());
+        End(w, true);
+    }
+    if( !model.extensionsRequired.empty() )
+    {
+        Begin(w, "extensionsRequired", true);
+        for( size_t i=0; i<model.extensionsRequired.size(); ++i )
+            w->string(w->ctx, 0, model.extensionsRequired[i].c_str());
+        End(w, true);
+    }
+
+    Begin(w, "scenes", true);
+    for( size_t i=0; i<model.scenes.size(); ++i )
+    {
+        Begin(w, 0, false);
+        String(w, "name", model.scenes[i].name);
+        Numbers(w, "nodes", model.scenes[i].nodes);
+        Extras(w, model.scenes[i].extras);
+        End(w, false);
+    }
+    End(w, true);
+
+    DescribeNodes(model, w);
+    DescribeMeshes(model, w);
+    DescribeAccessors(model, w);
+    DescribeBuffers(model, w);
+    DescribeMaterials(model, w);
+    DescribeAnimations(model, w);
+    DescribeCameras(model, w);
+    Extras(w, model.extras);
+
+    End(w, false);
+}
+
+// Compact json straight to the file, a stack of "first element" flags for the commas
+
+typedef struct JsonWriter {
+    FILE                *file;
+    std::vector<char>   first;
+} JsonWriter;
+
+static void JsonString( FILE *file, const char *s )
+{
+    fputc('"', file);
+    const char *run = s;
+    for( ; *s; ++s )
+    {
+        unsigned char c = (unsigned char)*s;
+        if( c >= 0x20 && c != '"' && c != '\\' ) continue;
+        fwrite(run, 1, s - run, file);
+        run = s + 1;
+        if( c == '"' || c == '\\' ) { fputc('\\', file); fputc(c, file); }
+        else if( c == '\n' ) fputs("\\n", file);
+        else if( c == '\t' ) fputs("\\t", file);
+        else fprintf(file, "\\u%04x", c);
+    }
+    fwrite(run, 1, s - run, file);
+    fputc('"', file);
+}
+
+static void JsonKey( JsonWriter *json, const char *key )
+{
+    if( !json->first.empty() )
+    {
+        if( !json->first.back() ) fputc(',', json->file);
+        json->first.back() = 0;
+    }
+    if( key )
+    {
+        JsonString(json->file, key);
+        fputc(':', json->file);
+    }
+}
+
+static void JsonBegin( void *ctx, const char *key, bool array )
+{
+    JsonWriter *json = (JsonWriter *)ctx;
+    JsonKey(json, key);
+    fputc(array ? '[' : '{', json->file);
+    json->first.push_back(1);
+}
+
+static void JsonEnd( void *ctx, bool array )
+{
+    JsonWriter *json = (JsonWriter *)ctx;
+    json->first.pop_back();
+    fputc(array ? ']' : '}', json->file);
+}
+
+static void JsonNumber( void *ctx, const char *key, double value )
+{
+    JsonWriter *json = (JsonWriter *)ctx;
+    JsonKey(json, key);
+    if( !isfinite(value) ) fputs("null", json->file);
+    // Integers (counts, byte lengths) exactly, the rest with float precision
+    else if( value == floor(value) && fabs(value) < 1e15 ) fprintf(json->file, "%.0f", value);
+    else fprintf(json->file, "%.9g", value);
+}
+
+static void JsonStringValue( void *ctx, const char *key, const char *value )
+{
+    JsonWriter *json = (JsonWriter *)ctx;
+    JsonKey(json, key);
+    JsonString(json->file, value);
+}
+
+static void JsonBoolean( void *ctx, const char *key, bool value )
+{
+    JsonWriter *json = (JsonWriter *)ctx;
+    JsonKey(json, key);
+    fputs(value ? "true" : "false", json->file);
+}
+
+bool WriteModelDescription( const tinygltf::Model &model, FILE *file )
+{
+    JsonWriter json;
+    json.file = file;
+    DescribeWriter writer = { &json, JsonBegin, JsonEnd, JsonNumber, JsonStringValue, JsonBoolean };
+    DescribeModel(model, &writer);
+    fputc('\n', file);
+    return fflush(file) == 0 && !ferror(file);
+}
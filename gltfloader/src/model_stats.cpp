@@ -0,0 +1,269 @@
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "model_stats.h"
+#include "gltf_profile.h"
+
+// Strings up to the small string capacity live inside the object itself
+static uint64_t StringBytes( const std::string &s )
+{
+    static const size_t inplace = std::string().capacity();
+    return s.capacity() > inplace ? s.capacity() + 1 : 0;
+}
+
+template <typename T>
+static uint64_t VectorBytes( const std::vector<T> &v )
+{
+    return (uint64_t)v.capacity() * sizeof(T);
+}
+
+// A tree node is the value plus the colour and three links
+template <typename K, typename V>
+static uint64_t MapNodeBytes( const std::map<K, V> &m )
+{
+    return (uint64_t)m.size() * (sizeof(typename std::map<K, V>::value_type) + 4 * sizeof(void *));
+}
+
+static uint64_t ValueBytes( const tinygltf::Value &value );
+
+static uint64_t ObjectBytes( const std::map<std::string, tinygltf::Value> &object )
+{
+    uint64_t bytes = MapNodeBytes(object);
+    for( std::map<std::string, tinygltf::Value>::const_iterator it = object.begin(); it != object.end(); ++it )
+        bytes += StringBytes(it->first) + ValueBytes(it->second);
+    return bytes;
+}
+
+static uint64_t ValueBytes( const tinygltf::Value &value )
+{
+    if( value.IsString() ) return StringBytes(value.Get<std::string>());
+    if( value.IsBinary() ) return VectorBytes(value.Get<std::vector<unsigned char> >());
+    if( value.IsObject() ) return ObjectBytes(value.Get<tinygltf::Value::Object>());
+    if( value.IsArray() )
+    {
+        const tinygltf::Value::Array &array = value.Get<tinygltf::Value::Array>();
+        uint64_t bytes = VectorBytes(array);
+        for( size_t i=0; i<array.size(); ++i )
+            bytes += ValueBytes(array[i]);
+        return bytes;
+    }
+    return 0;
+}
+
+// extras, extensions and their json strings, which every glTF object has
+template <typename T>
+static uint64_t CommonBytes( const T &object )
+{
+    return ValueBytes(object.extras) + ObjectBytes(object.extensions) +
+           StringBytes(object.extras_json_string) + StringBytes(object.extensions_json_string);
+}
+
+static uint64_t IndexMapBytes( const std::map<std::string, int> &m )
+{
+    uint64_t bytes = MapNodeBytes(m);
+    for( std::map<std::string, int>::const_iterator it = m.begin(); it != m.end(); ++it )
+        bytes += StringBytes(it->first);
+    return bytes;
+}
+
+static uint64_t ParameterMapBytes( const tinygltf::ParameterMap &m )
+{
+    uint64_t bytes = MapNodeBytes(m);
+    for( tinygltf::ParameterMap::const_iterator it = m.begin(); it != m.end(); ++it )
+    {
+        const tinygltf::Parameter &param = it->second;
+        bytes += StringBytes(it->first) + StringBytes(param.string_value) + VectorBytes(param.number_array);
+        bytes += MapNodeBytes(param.json_double_value);
+        for( std::map<std::string, double>::const_iterator d = param.json_double_value.begin(); d != param.json_double_value.end(); ++d )
+            bytes += StringBytes(d->first);
+    }
+    return bytes;
+}
+
+static uint64_t AccessorBytes( const tinygltf::Model &model )
+{
+    uint64_t bytes = VectorBytes(model.accessors);
+    for( size_t i=0; i<model.accessors.size(); ++i )
+    {
+        const tinygltf::Accessor &accessor = model.accessors[i];
+        bytes += StringBytes(accessor.name) + VectorBytes(accessor.minValues) + VectorBytes(accessor.maxValues);
+        bytes += CommonBytes(accessor) + CommonBytes(accessor.sparse);
+        bytes += CommonBytes(accessor.sparse.indices) + CommonBytes(accessor.sparse.values);
+    }
+    return bytes;
+}
+
+static uint64_t MaterialBytes( const tinygltf::Material &material )
+{
+    uint64_t bytes = StringBytes(material.name) + StringBytes(material.alphaMode) + VectorBytes(material.emissiveFactor);
+    bytes += VectorBytes(material.lods) + CommonBytes(material);
+    bytes += VectorBytes(material.pbrMetallicRoughness.baseColorFactor) + CommonBytes(material.pbrMetallicRoughness);
+    bytes += CommonBytes(material.pbrMetallicRoughness.baseColorTexture);
+    bytes += CommonBytes(material.pbrMetallicRoughness.metallicRoughnessTexture);
+    bytes += CommonBytes(material.normalTexture) + CommonBytes(material.occlusionTexture) + CommonBytes(material.emissiveTexture);
+    bytes += ParameterMapBytes(material.values) + ParameterMapBytes(material.additionalValues);
+    return bytes;
+}
+
+static uint64_t MeshBytes( const tinygltf::Mesh &mesh )
+{
+    uint64_t bytes = StringBytes(mesh.name) + VectorBytes(mesh.weights) + VectorBytes(mesh.primitives) + CommonBytes(mesh);
+    for( size_t p=0; p<mesh.primitives.size(); ++p )
+    {
+        const tinygltf::Primitive &prim = mesh.primitives[p];
+        bytes += IndexMapBytes(prim.attributes) + VectorBytes(prim.targets) + CommonBytes(prim);
+        for( size_t t=0; t<prim.targets.size(); ++t )
+            bytes += IndexMapBytes(prim.targets[t]);
+    }
+    return bytes;
+}
+
+static uint64_t NodeBytes( const tinygltf::Node &node )
+{
+    return StringBytes(node.name) + VectorBytes(node.children) + VectorBytes(node.lods) +
+           VectorBytes(node.rotation) + VectorBytes(node.scale) + VectorBytes(node.translation) +
+           VectorBytes(node.matrix) + VectorBytes(node.weights) + CommonBytes(node);
+}
+
+static uint64_t AnimationBytes( const tinygltf::Animation &animation )
+{
+    uint64_t bytes = StringBytes(animation.name) + VectorBytes(animation.channels) + VectorBytes(animation.samplers) + CommonBytes(animation);
+    for( size_t c=0; c<animation.channels.size(); ++c )
+    {
+        const tinygltf::AnimationChannel &channel = animation.channels[c];
+        bytes += StringBytes(channel.target_path) + CommonBytes(channel);
+        bytes += ValueBytes(channel.target_extras) + ObjectBytes(channel.target_extensions);
+        bytes += StringBytes(channel.target_extras_json_string) + StringBytes(channel.target_extensions_json_string);
+    }
+    for( size_t s=0; s<animation.samplers.size(); ++s )
+        bytes += StringBytes(animation.samplers[s].interpolation) + CommonBytes(animation.samplers[s]);
+    return bytes;
+}
+
+// Everything that is not buffer data, pixels or accessors
+static uint64_t StructureBytes( const tinygltf::Model &model )
+{
+    uint64_t bytes = VectorBytes(model.buffers) + VectorBytes(model.images);
+    for( size_t i=0; i<model.buffers.size(); ++i )
+        bytes += StringBytes(model.buffers[i].name) + StringBytes(model.buffers[i].uri) + CommonBytes(model.buffers[i]);
+    for( size_t i=0; i<model.images.size(); ++i )
+    {
+        const tinygltf::Image &image = model.images[i];
+        bytes += StringBytes(image.name) + StringBytes(image.uri) + StringBytes(image.mimeType) + CommonBytes(image);
+    }
+
+    bytes += VectorBytes(model.bufferViews);
+    for( size_t i=0; i<model.bufferViews.size(); ++i )
+        bytes += StringBytes(model.bufferViews[i].name) + CommonBytes(model.bufferViews[i]);
+
+    bytes += VectorBytes(model.meshes);
+    for( size_t i=0; i<model.meshes.size(); ++i )
+        bytes += MeshBytes(model.meshes[i]);
+
+    bytes += VectorBytes(model.nodes);
+    for( size_t i=0; i<model.nodes.size(); ++i )
+        bytes += NodeBytes(model.nodes[i]);
+
+    bytes += VectorBytes(model.materials);
+    for( size_t i=0; i<model.materials.size(); ++i )
+        bytes += MaterialBytes(model.materials[i]);
+
+    bytes += VectorBytes(model.textures);
+    for( size_t i=0; i<model.textures.size(); ++i )
+        bytes += StringBytes(model.textures[i].name) + CommonBytes(model.textures[i]);
+
+    bytes += VectorBytes(model.samplers);
+    for( size_t i=0; i<model.samplers.size(); ++i )
+        bytes += StringBytes(model.samplers[i].name) + CommonBytes(model.samplers[i]);
+
+    bytes += VectorBytes(model.animations);
+    for( size_t i=0; i<model.animations.size(); ++i )
+        bytes += AnimationBytes(model.animations[i]);
+
+    bytes += VectorBytes(model.skins);
+    for( size_t i=0; i<model.skins.size(); ++i )
+        bytes += StringBytes(model.skins[i].name) + VectorBytes(model.skins[i].joints) + CommonBytes(model.skins[i]);
+
+    bytes += VectorBytes(model.cameras);
+    for( size_t i=0; i<model.cameras.size(); ++i )
+    {
+        const tinygltf::Camera &camera = model.cameras[i];
+        bytes += StringBytes(camera.name) + StringBytes(camera.type) + CommonBytes(camera);
+        bytes += CommonBytes(camera.perspective) + CommonBytes(camera.orthographic);
+    }
+
+    bytes += VectorBytes(model.scenes);
+    for( size_t i=0; i<model.scenes.size(); ++i )
+    {
+        const tinygltf::Scene &scene = model.scenes[i];
+        bytes += StringBytes(scene.name) + VectorBytes(scene.nodes) + VectorBytes(scene.audioEmitters) + CommonBytes(scene);
+    }
+
+    bytes += VectorBytes(model.lights);
+    for( size_t i=0; i<model.lights.size(); ++i )
+    {
+        const tinygltf::Light &light = model.lights[i];
+        bytes += StringBytes(light.name) + StringBytes(light.type) + VectorBytes(light.color);
+        bytes += CommonBytes(light) + CommonBytes(light.spot);
+    }
+
+    bytes += VectorBytes(model.extensionsUsed) + VectorBytes(model.extensionsRequired);
+    for( size_t i=0; i<model.extensionsUsed.size(); ++i )
+        bytes += StringBytes(model.extensionsUsed[i]);
+    for( size_t i=0; i<model.extensionsRequired.size(); ++i )
+        bytes += StringBytes(model.extensionsRequired[i]);
+
+    const tinygltf::Asset &asset = model.asset;
+    bytes += StringBytes(asset.version) + StringBytes(asset.generator) + StringBytes(asset.minVersion) + StringBytes(asset.copyright);
+    bytes += CommonBytes(asset) + CommonBytes(model);
+    return bytes;
+}
+
+void GetModelMemory( const tinygltf::Model &model, ModelMemory *out )
+{
+    GLTF_PROFILE("GltfModelMemory");
+    out->buffers = 0;
+    for( size_t i=0; i<model.buffers.size(); ++i )
+        out->buffers += VectorBytes(model.buffers[i].data);
+    out->images = 0;
+    for( size_t i=0; i<model.images.size(); ++i )
+        out->images += VectorBytes(model.images[i].image);
+    out->accessors = AccessorBytes(model);
+    out->structures = StructureBytes(model);
+    out->total = out->buffers + out->images + out->accessors + out->structures;
+}
+
+void GetModelGeometry( const tinygltf::Model &model, ModelGeometry *out )
+{
+    out->meshes = (uint32_t)model.meshes.size();
+    out->nodes = (uint32_t)model.nodes.size();
+    out->primitives = 0;
+    out->vertices = 0;
+    out->triangles = 0;
+    int accessorcount = (int)model.accessors.size();
+    for( size_t m=0; m<model.meshes.size(); ++m )
+    {
+        const tinygltf::Mesh &mesh = model.meshes[m];
+        out->primitives += (uint32_t)mesh.primitives.size();
+        for( size_t p=0; p<mesh.primitives.size(); ++p )
+        {
+            const tinygltf::Primitive &prim = mesh.primitives[p];
+            uint64_t vertices = 0;
+            std::map<std::string, int>::const_iterator it = prim.attributes.find("POSITION");
+            if( it != prim.attributes.end() && it->second >= 0 && it->second < accessorcount )
+                vertices = model.accessors[it->second].count;
+            out->vertices += vertices;
+
+            uint64_t count = vertices;
+            if( prim.indices >= 0 && prim.indices < accessorcount )
+                count = model.accessors[prim.indices].count;
+            if( prim.mode == -1 || prim.mode == TINYGLTF_MODE_TRIANGLES )
+                out->triangles += count / 3;
+            else if( (prim.mode == TINYGLTF_MODE_TRIANGLE_STRIP || prim.mode == TINYGLTF_MODE_TRIANGLE_FAN) && count > 2 )
+                out->triangles += count - 2;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "scene.h"
+#include "gltf_profile.h"
+
+static const float IDENTITY[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+
+void ComposeMatrix( const float *t, const float *r, const float *s, float *m )
+{
+    float x = r[0], y = r[1], z = r[2], w = r[3];
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+
+    m[0] = (1 - 2 * (yy + zz)) * s[0];
+    m[1] = (2 * (xy + wz)) * s[0];
+    m[2] = (2 * (xz - wy)) * s[0];
+    m[3] = 0;
+    m[4] = (2 * (xy - wz)) * s[1];
+    m[5] = (1 - 2 * (xx + zz)) * s[1];
+    m[6] = (2 * (yz + wx)) * s[1];
+    m[7] = 0;
+    m[8] = (2 * (xz + wy)) * s[2];
+    m[9] = (2 * (yz - wx)) * s[2];
+    m[10] = (1 - 2 * (xx + yy)) * s[2];
+    m[11] = 0;
+    m[12] = t[0];
+    m[13] = t[1];
+    m[14] = t[2];
+    m[15] = 1;
+}
+
+void MultiplyMatrix( const float *a, const float *b, float *out )
+{
+    float r[16];
+    for( int c=0; c<4; ++c )
+    {
+        for( int row=0; row<4; ++row )
+        {
+            r[c * 4 + row] = a[0 * 4 + row] * b[c * 4 + 0] + a[1 * 4 + row] * b[c * 4 + 1]
+                           + a[2 * 4 + row] * b[c * 4 + 2] + a[3 * 4 + row] * b[c * 4 + 3];
+        }
+    }
+    memcpy(out, r, sizeof(r));
+}
+
+void DecomposeMatrix( const float *m, float *t, float *r, float *s )
+{
+    t[0] = m[12]; t[1] = m[13]; t[2] = m[14];
+
+    s[0] = sqrtf(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+    s[1] = sqrtf(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]);
+    s[2] = sqrtf(m[8] * m[8] + m[9] * m[9] + m[10] * m[10]);
+
+    float det = m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+    if( det < 0.0f ) s[0] = -s[0];
+
+    float is[3];
+    for( int i=0; i<3; ++i ) is[i] = s[i] != 0.0f ? 1.0f / s[i] : 0.0f;
+    float r00 = m[0] * is[0], r10 = m[1] * is[0], r20 = m[2] * is[0];
+    float r01 = m[4] * is[1], r11 = m[5] * is[1], r21 = m[6] * is[1];
+    float r02 = m[8] * is[2], r12 = m[9] * is[2], r22 = m[10] * is[2];
+
+    // Shepperd's method, picks the largest diagonal term for stability
+    float trace = r00 + r11 + r22;
+    if( trace > 0.0f )
+    {
+        float k = 0.5f / sqrtf(trace + 1.0f);
+        r[3] = 0.25f / k;
+        r[0] = (r21 - r12) * k;
+        r[1] = (r02 - r20) * k;
+        r[2] = (r10 - r01) * k;
+    }
+    else if( r00 > r11 && r00 > r22 )
+    {
+        float k = 2.0f * sqrtf(1.0f + r00 - r11 - r22);
+        r[3] = (r21 - r12) / k;
+        r[0] = 0.25f * k;
+        r[1] = (r01 + r10) / k;
+        r[2] = (r02 + r20) / k;
+    }
+    else if( r11 > r22 )
+    {
+        float k = 2.0f * sqrtf(1.0f + r11 - r00 - r22);
+        r[3] = (r02 - r20) / k;
+        r[0] = (r01 + r10) / k;
+        r[1] = 0.25f * k;
+        r[2] = (r12 + r21) / k;
+    }
+    else
+    {
+        float k = 2.0f * sqrtf(1.0f + r22 - r00 - r11);
+        r[3] = (r10 - r01) / k;
+        r[0] = (r02 + r20) / k;
+        r[1] = (r12 + r21) / k;
+        r[2] = 0.25f * k;
+    }
+}
+
+void GetNodeTRS( const tinygltf::Node &node, float *t, float *r, float *s )
+{
+    t[0] = t[1] = t[2] = 0.0f;
+    r[0] = r[1] = r[2] = 0.0f; r[3] = 1.0f;
+    s[0] = s[1] = s[2] = 1.0f;
+    if( node.translation.size() == 3 )
+        for( int i=0; i<3; ++i ) t[i] = (float)node.translation[i];
+    if( node.rotation.size() == 4 )
+        for( int i=0; i<4; ++i ) r[i] = (float)node.rotation[i];
+    if( node.scale.size() == 3 )
+        for( int i=0; i<3; ++i ) s[i] = (float)node.scale[i];
+}
+
+void GetNodeLocalMatrix( const tinygltf::Node &node, float *m )
+{
+    if( node.matrix.size() == 16 )
+    {
+        for( int i=0; i<16; ++i ) m[i] = (float)node.matrix[i];
+        return;
+    }
+    float t[3], r[4], s[3];
+    GetNodeTRS(node, t, r, s);
+    ComposeMatrix(t, r, s, m);
+}
+
+void GetSceneRoots( const tinygltf::Model &model, int scene, std::vector<int> &roots )
+{
+    roots.clear();
+    if( scene < 0 ) scene = model.defaultScene;
+    if( scene < 0 && !model.scenes.empty() ) scene = 0;
+
+    if( scene >= 0 && scene < (int)model.scenes.size() )
+    {
+        roots = model.scenes[scene].nodes;
+        return;
+    }
+
+    std::vector<char> haschild(model.nodes.size(), 0);
+    for( size_t n=0; n<model.nodes.size(); ++n )
+    {
+        for( size_t c=0; c<model.nodes[n].children.size(); ++c )
+        {
+            int child = model.nodes[n].children[c];
+            if( child >= 0 && child < (int)haschild.size() ) haschild[child] = 1;
+        }
+    }
+    for( size_t n=0; n<model.nodes.size(); ++n )
+    {
+        if( !haschild[n] ) roots.push_back((int)n);
+    }
+}
+
+void ComputeWorldMatrices( const tinygltf::Model &model, int scene, std::vector<float> &matrices, std::vector<int> *order )
+{
+    GLTF_PROFILE("GltfWorldMatrices");
+    size_t count = model.nodes.size();
+    matrices.resize(count * 16);
+    for( size_t n=0; n<count; ++n )
+        memcpy(&matrices[n * 16], IDENTITY, sizeof(IDENTITY));
+    if( order ) order->clear();
+
+    // Explicit stack, parents are always done before their children
+    std::vector<int> roots;
+    GetSceneRoots(model, scene, roots);
+    std::vector< std::pair<int, int> > stack;     // node, parent
+    for( size_t i=roots.size(); i>0; --i )
+        stack.push_back(std::make_pair(roots[i - 1], -1));
+
+    std::vector<char> visited(count, 0);
+    while( !stack.empty() )
+    {
+        int node = stack.back().first;
+        int parent = stack.back().second;
+        stack.pop_back();
+        if( node < 0 || node >= (int)count || visited[node] ) continue;
+        visited[node] = 1;
+
+        float local[16];
+        GetNodeLocalMatrix(model.nodes[node], local);
+        if( parent >= 0 )
+            MultiplyMatrix(&matrices[parent * 16], local, &matrices[node * 16]);
+        else
+            memcpy(&matrices[node * 16], local, sizeof(local));
+        if( order ) order->push_back(node);
+
+        const std::vector<int> &children = model.nodes[node].children;
+        for( size_t c=children.size(); c>0; --c )
+            stack.push_back(std::make_pair(children[c - 1], node));
+    }
+}
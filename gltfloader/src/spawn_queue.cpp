@@ -0,0 +1,249 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// include the Defold SDK
+#include <dmsdk/sdk.h>
+
+#include "mesh_pool.h"
+#include "spawn_queue.h"
+
+// How many spawns between clock reads
+#define SPAWN_TIME_CHECK_INTERVAL   16
+
+typedef struct SpawnJob {
+    int                         id;
+    std::vector<SpawnTransform> transforms;
+    std::vector<uint32_t>       indices;        // Reserved collection indices
+    size_t                      nextindex;
+    size_t                      next;           // Next transform to spawn
+    std::vector<dmhash_t>       spawned;        // 0 for failed spawns, keeps ids in transform order
+    dmhash_t                    vertices;
+    std::vector<dmhash_t>       itemvertices;   // Per transform, scene jobs only
+    std::vector<int>            nodes;          // Node per transform, scene jobs only
+    bool                        scene;
+    bool                        cancelled;      // Cancelled from its own progress callback
+    dmScript::LuaCallbackInfo   *callback;
+} SpawnJob;
+
+static std::vector<SpawnJob *>  g_jobs;
+static SpawnJob                 *g_reporting = 0;   // Job whose progress callback is running
+static int                      g_nextjobid = 1;
+static uint64_t                 g_budget = (uint64_t)(SPAWN_DEFAULT_BUDGET_MS * 1000.0f);   // Microseconds
+
+static const dmhash_t           MESH_COMPONENT = dmHashString64(MESH_POOL_COMPONENT);
+static const dmhash_t           VERTICES_PROPERTY = dmHashString64("vertices");
+
+static void DestroyJob( SpawnJob *job )
+{
+    ReleaseMeshIndices(job->indices, job->nextindex);
+    if( job->callback ) dmScript::DestroyCallback(job->callback);
+    delete job;
+}
+
+void InitSpawnQueue( dmConfigFile::HConfig config )
+{
+    SetSpawnBudget(dmConfigFile::GetFloat(config, "gltfloader.spawn_budget_ms", SPAWN_DEFAULT_BUDGET_MS));
+}
+
+void ClearSpawnQueue()
+{
+    for( size_t i=0; i<g_jobs.size(); ++i )
+        DestroyJob(g_jobs[i]);
+    g_jobs.clear();
+}
+
+void SetSpawnBudget( float ms )
+{
+    // Always make some progress, even with a zero budget
+    g_budget = ms > 0.0f ? (uint64_t)(ms * 1000.0f) : 1;
+}
+
+static SpawnJob *NewJob( std::vector<SpawnTransform> &transforms, dmScript::LuaCallbackInfo *callback )
+{
+    SpawnJob *job = new SpawnJob;
+    job->id = g_nextjobid++;
+    job->transforms.swap(transforms);
+    job->nextindex = 0;
+    job->next = 0;
+    job->spawned.reserve(job->transforms.size());
+    job->vertices = 0;
+    job->scene = false;
+    job->cancelled = false;
+    job->callback = callback;
+    return job;
+}
+
+int QueueSpawnBatch( std::vector<SpawnTransform> &transforms, dmhash_t vertices, dmScript::LuaCallbackInfo *callback )
+{
+    SpawnJob *job = NewJob(transforms, callback);
+    job->vertices = vertices;
+
+    AcquireMeshIndices((uint32_t)job->transforms.size(), job->indices);
+    g_jobs.push_back(job);
+    return job->id;
+}
+
+int QueueSpawnScene( std::vector<SpawnTransform> &transforms, std::vector<int> &nodes,
+                     std::vector<dmhash_t> &vertices, dmScript::LuaCallbackInfo *callback )
+{
+    SpawnJob *job = NewJob(transforms, callback);
+    job->nodes.swap(nodes);
+    job->itemvertices.swap(vertices);
+    job->scene = true;
+
+    AcquireMeshIndices((uint32_t)job->transforms.size(), job->indices);
+    g_jobs.push_back(job);
+    return job->id;
+}
+
+bool CancelSpawnJob( int id )
+{
+    for( size_t i=0; i<g_jobs.size(); ++i )
+    {
+        if( g_jobs[i]->id == id && !g_jobs[i]->cancelled )
+        {
+            if( g_jobs[i] == g_reporting )
+            {
+                g_reporting->cancelled = true;
+                return true;
+            }
+            DestroyJob(g_jobs[i]);
+            g_jobs.erase(g_jobs.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GetSpawnJobProgress( int id, uint32_t *done, uint32_t *total )
+{
+    for( size_t i=0; i<g_jobs.size(); ++i )
+    {
+        if( g_jobs[i]->id == id && !g_jobs[i]->cancelled )
+        {
+            *done = (uint32_t)g_jobs[i]->next;
+            *total = (uint32_t)g_jobs[i]->transforms.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+static void SpawnOne( SpawnJob *job )
+{
+    size_t item = job->next++;
+    const SpawnTransform &t = job->transforms[item];
+    dmVMath::Point3 position(t.position[0], t.position[1], t.position[2]);
+    dmVMath::Quat rotation(t.rotation[0], t.rotation[1], t.rotation[2], t.rotation[3]);
+    dmVMath::Vector3 scale(t.scale[0], t.scale[1], t.scale[2]);
+
+    dmGameObject::HInstance instance = SpawnPooledMeshReserved(job->indices, &job->nextindex, position, rotation, scale);
+    if( instance == 0 )
+    {
+        job->spawned.push_back(0);
+        return;
+    }
+
+    dmhash_t vertices = job->itemvertices.empty() ? job->vertices : job->itemvertices[item];
+    if( vertices )
+    {
+        dmGameObject::PropertyOptions options;
+        dmGameObject::PropertyVar var(vertices);
+        dmGameObject::PropertyResult r = dmGameObject::SetProperty(instance, MESH_COMPONENT, VERTICES_PROPERTY, options, var);
+        if( r != dmGameObject::PROPERTY_RESULT_OK )
+            dmLogWarning("Failed to set vertices '%s' on '%s' (%d)", dmHashReverseSafe64(vertices),
+                         dmHashReverseSafe64(dmGameObject::GetIdentifier(instance)), r);
+    }
+    job->spawned.push_back(dmGameObject::GetIdentifier(instance));
+}
+
+// Batch jobs: { id ... } in transform order, scene jobs: { [node + 1] = id }
+static void PushSpawnedIds( lua_State *L, SpawnJob *job )
+{
+    lua_createtable(L, job->scene ? 0 : job->spawned.size(), job->scene ? job->spawned.size() : 0);
+    for( size_t i=0; i<job->spawned.size(); ++i )
+    {
+        if( job->spawned[i] )
+            dmScript::PushHash(L, job->spawned[i]);
+        else
+            lua_pushboolean(L, 0);
+        lua_rawseti(L, -2, (job->scene ? job->nodes[i] : (int)i) + 1);
+    }
+}
+
+static void InvokeCallback( SpawnJob *job, bool finished )
+{
+    if( !dmScript::IsCallbackValid(job->callback) ) return;
+
+    lua_State* L = dmScript::GetCallbackLuaContext(job->callback);
+    DM_LUA_STACK_CHECK(L, 0);
+    if( !dmScript::SetupCallback(job->callback) ) return;
+
+    lua_pushnumber(L, job->id);
+    if( job->scene )
+    {
+        lua_createtable(L, 0, 4);
+        lua_pushnumber(L, job->next);
+        lua_setfield(L, -2, "done");
+        lua_pushnumber(L, job->transforms.size());
+        lua_setfield(L, -2, "total");
+        lua_pushboolean(L, finished);
+        lua_setfield(L, -2, "finished");
+        if( finished )
+        {
+            PushSpawnedIds(L, job);
+            lua_setfield(L, -2, "ids");
+        }
+    }
+    else
+        PushSpawnedIds(L, job);
+    dmScript::PCall(L, 3, 0);       // self, job, ids or progress
+    dmScript::TeardownCallback(job->callback);
+}
+
+void UpdateSpawnQueue()
+{
+    DM_PROFILE("GltfSpawnQueue");
+    if( g_jobs.empty() ) return;
+
+    uint64_t start = dmTime::GetMonotonicTime();
+    uint32_t spawns = 0;
+    bool outoftime = false;
+    while( !g_jobs.empty() && !outoftime )
+    {
+        SpawnJob *job = g_jobs.front();
+        while( job->next < job->transforms.size() )
+        {
+            SpawnOne(job);
+            if( (++spawns % SPAWN_TIME_CHECK_INTERVAL) == 0 && dmTime::GetMonotonicTime() - start >= g_budget )
+            {
+                outoftime = true;
+                break;
+            }
+        }
+        if( job->next < job->transforms.size() )
+        {
+            // Out of time, scene jobs report how far they got
+            if( job->scene )
+            {
+                g_reporting = job;
+                InvokeCallback(job, false);
+                g_reporting = 0;
+                if( job->cancelled )
+                {
+                    g_jobs.erase(std::find(g_jobs.begin(), g_jobs.end(), job));
+                    DestroyJob(job);
+                }
+            }
+            break;
+        }
+
+        // Off the queue before the callback, it may queue or cancel jobs
+        g_jobs.erase(g_jobs.begin());
+        InvokeCallback(job, true);
+        DestroyJob(job);
+    }
+}
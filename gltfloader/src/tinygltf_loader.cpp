@@ -5,20 +5,18 @@
 // #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "tiny_gltf.h"
-#include "tinygltf_dump.h"
+#include "model_describe.h"
+#include "image_decode.h"
+#include "tinygltf_loader.h"
+#include "mesh_pool.h"
+#include "gltf_parse.h"
 
 // include the Defold SDK
 #include <dmsdk/sdk.h>
 #include <dmsdk/gamesys/components/comp_collection_proxy.h>
 #include <dmsdk/gamesys/components/comp_factory.h>
 
-typedef struct DefoldModel
-{
-    tinygltf::Model model;
-
-} DefoldModel;
-
-static std::vector<tinygltf::Model>     g_models;
+static std::vector<DefoldModel>         g_models;
 
 static dmResource::HFactory             m_Factory;
 static dmConfigFile::HConfig            m_ConfigFile;
@@ -29,12 +27,57 @@ static dmGameObject::HCollection        m_LevelCollection;
 static dmGameSystem::HFactoryWorld      m_FactoryWorld;
 dmGameSystem::HFactoryComponent         m_MeshFactory;
 
-dmArray<dmGameObject::HInstance>        m_Meshes;
+// "assets/models/./a/../b.gltf" -> "/assets/models/b.gltf", the form resource names take
+static std::string GetResourceName(const char *path)
+{
+    std::vector<std::string> parts;
+    std::string part;
+    for(const char *c = path; ; ++c)
+    {
+        if(*c == '/' || *c == '\\' || *c == 0)
+        {
+            if(part == "..")
+            {
+                if(!parts.empty()) parts.pop_back();
+            }
+            else if(!part.empty() && part != ".")
+                parts.push_back(part);
+            part.clear();
+            if(*c == 0) break;
+        }
+        else
+            part += *c;
+    }
+    std::string name;
+    for(size_t i = 0; i < parts.size(); ++i)
+        name += "/" + parts[i];
+    return name;
+}
+
+// Model files are read through the resource system first, so they come out of the
+// game archive in a bundle (list the model folders in project.custom_resources).
+// Anything the resource system does not have is read from disk. Every file is one
+// GetRaw of the whole thing, which is how tinygltf and the bake reader consume them.
+static bool ReadResourceFile(const char *path, std::vector<unsigned char> *out, std::string *err, void *ctx)
+{
+    dmResource::HFactory factory = (dmResource::HFactory)ctx;
+    std::string name = GetResourceName(path);
+    void *data = 0;
+    uint32_t size = 0;
+    if(!name.empty() && dmResource::GetRaw(factory, name.c_str(), &data, &size) == dmResource::RESULT_OK)
+    {
+        out->assign((unsigned char *)data, (unsigned char *)data + size);
+        free(data);
+        return true;
+    }
+    return ReadGltfFile(path, out, err);
+}
 
 void InitMeshBuilding(dmResource::HFactory _Factory, dmConfigFile::HConfig _ConfigFile)
 {
     m_Factory = _Factory;
     m_ConfigFile = _ConfigFile;
+    SetGltfFileReader(ReadResourceFile, m_Factory);
 
     const char* path = dmConfigFile::GetString(m_ConfigFile, "bootstrap.main_collection", 0);
     dmResource::Result res = dmResource::Get(m_Factory, path, (void **)&m_MainCollection);
@@ -56,10 +99,19 @@ void InitMeshBuilding(dmResource::HFactory _Factory, dmConfigFile::HConfig _Conf
     uint32_t component_type_index;
     dmGameObject::Result r = dmGameObject::GetComponent(go, dmHashString64("meshfactory"), &component_type_index, (dmGameObject::HComponent *)&m_MeshFactory, (dmGameObject::HComponentWorld *)&m_FactoryWorld);
     assert(dmGameObject::RESULT_OK == r);
+
+    InitMeshPool(m_MainCollection, m_FactoryWorld, m_MeshFactory, m_ConfigFile);
+}
+
+dmGameObject::HCollection GetMainCollection()
+{
+    return m_MainCollection;
 }
 
 void DestroyMeshBuilding()
 {
+    SetGltfFileReader(0, 0);
+    DestroyMeshPool();
     if (m_MainCollection)
     {
         dmResource::Release(m_Factory, m_MainCollection);
@@ -67,75 +119,44 @@ void DestroyMeshBuilding()
     }    
 }
 
-static dmGameObject::HInstance SpawnMesh(dmGameSystem::HFactoryComponent factory)
+int GenerateGltfMesh(const tinygltf::Model &model)
 {
-    if (m_Meshes.Full())
-    {
-        dmLogWarning("Stars buffer is full, skipping spawn of new star.");
-        return 0;
-    }
-
-    uint32_t index = dmGameObject::AcquireInstanceIndex(m_MainCollection);
-    if (index == dmGameObject::INVALID_INSTANCE_POOL_INDEX)
-    {
-        dmLogError("Gameobject buffer is full. See `collection.max_instances` in game.project");
-        return 0;
-    }
 
-    dmhash_t starid = dmGameObject::ConstructInstanceId(index);
-
-    float y = 0.0f;
-    dmVMath::Point3 position(0.0f, y, 0.1f);
-    dmVMath::Quat rotation(0,0,0,1);
-    dmVMath::Vector3 scale(2.0f,2.0f,2.0f);
-
-    dmGameObject::HPropertyContainer properties = 0;
-
-    dmGameObject::HInstance instance = dmGameSystem::CompFactorySpawn(m_FactoryWorld, factory, m_MainCollection,
-                                                            index, starid, position, rotation, scale, properties);
-
-    m_Meshes.Push(instance);
-    return instance;
+    return 0;
 }
 
-int GenerateGltfMesh(const tinygltf::Model &model)
+int GetModelCount()
 {
+    return (int)g_models.size();
+}
 
-    return 0;
+DefoldModel *GetDefoldModel(int modelid)
+{
+    if (modelid < 0 || modelid >= (int)g_models.size())
+        return 0;
+    return &g_models[modelid];
 }
 
-int load_gltf(const char *gltf_filename, bool dump)
+tinygltf::Model *GetModel(int modelid)
 {
-    // Store original JSON string for `extras` and `extensions`
-    bool store_original_json_for_extras_and_extensions = false;
-    // if (argc > 2) {
-    //   store_original_json_for_extras_and_extensions = true;
-    // }
+    DefoldModel *dmodel = GetDefoldModel(modelid);
+    return dmodel ? &dmodel->model : 0;
+}
 
+int load_gltf(const char *gltf_filename, bool dump, uint32_t flags)
+{
+    DM_PROFILE("GltfLoad");
+    uint64_t start = dmTime::GetMonotonicTime();
     tinygltf::Model model;
-    tinygltf::TinyGLTF gltf_ctx;
     std::string err;
     std::string warn;
-    std::string input_filename(gltf_filename);
-    std::string ext = tinygltf::GetFilePathExtension(input_filename);
+    bool cached = false;
+    LoadTimings timings;
 
-    gltf_ctx.SetStoreOriginalJSONForExtrasAndExtensions(
-        store_original_json_for_extras_and_extensions);
-
-    bool ret = false;
-    if (ext.compare("glb") == 0)
-    {
-        std::cout << "Reading binary glTF" << std::endl;
-        // assume binary glTF.
-        ret = gltf_ctx.LoadBinaryFromFile(&model, &err, &warn,
-                                          input_filename.c_str());
-    }
-    else
-    {
-        std::cout << "Reading ASCII glTF" << std::endl;
-        // assume ascii glTF.
-        ret = gltf_ctx.LoadASCIIFromFile(&model, &err, &warn, input_filename.c_str());
-    }
+    bool ret = ParseGltf(gltf_filename, flags, model, &err, &warn, &cached, &timings.parse);
+    timings.cached = cached;
+    if (cached)
+        printf("Read baked glTF %s\n", gltf_filename);
 
     if (!warn.empty())
     {
@@ -153,11 +174,35 @@ int load_gltf(const char *gltf_filename, bool dump)
         return -1;
     }
 
+    // Lazy loads keep the encoded png/jpg bytes, get_image decodes on first use
+    err.clear();
+    uint64_t decodestart = dmTime::GetMonotonicTime();
+    if (!(flags & LOAD_LAZY_IMAGES) && !DecodeImages(model, &err))
+    {
+        printf("Err: %s\n", err.c_str());
+        printf("Failed to decode glTF images\n");
+        return -1;
+    }
+    timings.images = dmTime::GetMonotonicTime() - decodestart;
+
+    // The same summary gltfloader.describe gives, as one line of json
     if (dump)
-        Dump(model);
+        WriteModelDescription(model, stdout);
 
     int modelid = g_models.size();
-    g_models.push_back(model);
+    g_models.push_back(DefoldModel());
+    DefoldModel &dmodel = g_models.back();
+    dmodel.model = std::move(model);
+    ComputeModelBounds(dmodel.model, dmodel.bounds);
+    BuildAnimationClips(dmodel.model, dmodel.animations);
+    GetRestPose(dmodel.model, dmodel.restpose);
+    dmodel.timings = timings;
+    dmodel.timings.total = dmTime::GetMonotonicTime() - start;
 
     return modelid;
 }
+
+void ClearModels()
+{
+    g_models.clear();
+}
@@ -21,7 +21,10 @@ static int Encode(lua_State* L, LodePNGColorType type) {
     // encode to png
     unsigned char* out = 0;
     size_t outsize = 0;
-    lodepng_encode_memory(&out, &outsize, (unsigned char*)pixels, w, h, type, 8);
+    {
+        DM_PROFILE("PngEncode");
+        lodepng_encode_memory(&out, &outsize, (unsigned char*)pixels, w, h, type, 8);
+    }
 
     // put the pixel data onto the stack
     lua_pushlstring(L, (char*)out, outsize);
@@ -34,6 +37,7 @@ static int Encode(lua_State* L, LodePNGColorType type) {
  * Convert RGB pixel data to a PNG of the same colortype
  */
 static int EncodeRGB(lua_State* L) {
+    DM_PROFILE("png.encode_rgb");
     return Encode(L, LCT_RGB);
 }
 
@@ -41,6 +45,7 @@ static int EncodeRGB(lua_State* L) {
  * Convert RGBA pixel data to a PNG of the same colortype
  */
 static int EncodeRGBA(lua_State* L) {
+    DM_PROFILE("png.encode_rgba");
     return Encode(L, LCT_RGBA);
 }
 
@@ -73,7 +78,10 @@ static int ToBuffer(lua_State* L, LodePNGColorType type) {
             bytes_per_pixel = 3;
             break;
     }
-    lodepng_decode(&pixels, &outw, &outh, &state, (unsigned char*)png, png_length);
+    {
+        DM_PROFILE("PngDecode");
+        lodepng_decode(&pixels, &outw, &outh, &state, (unsigned char*)png, png_length);
+    }
 
     // // flip vertically
     // for (int yi=0; yi < (outh / 2); yi++) {
@@ -156,6 +164,7 @@ static int ToBuffer(lua_State* L, LodePNGColorType type) {
  * Convert PNG to an RGB buffer
  */
 static int DecodeRGB(lua_State* L) {
+    DM_PROFILE("png.decode_rgb");
     return ToBuffer(L, LCT_RGB);
 }
 
@@ -163,6 +172,7 @@ static int DecodeRGB(lua_State* L) {
  * Convert PNG to an RGBA buffer
  */
 static int DecodeRGBA(lua_State* L) {
+    DM_PROFILE("png.decode_rgba");
     return ToBuffer(L, LCT_RGBA);
 }
 
@@ -170,6 +180,7 @@ static int DecodeRGBA(lua_State* L) {
  * Get information about a PNG
  */
 static int Info(lua_State* L) {
+    DM_PROFILE("png.info");
     int top = lua_gettop(L);
 
     size_t png_length;
@@ -0,0 +1,189 @@
+// geombench - rays/second and noise samples/second for the geom.cpp kernels
+//
+//   make run                                       all benchmarks
+//   make run ARGS="--benchmark_filter=Raycast"     the usual Google Benchmark flags
+//
+// Box fields hold 1k, 10k and 100k randomly placed and rotated boxes (fixed
+// seed, so runs compare), rays start outside the field and point across it.
+
+#include <math.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// include the Defold SDK (the stub one, see tools/stub)
+#include <dmsdk/sdk.h>
+
+#include "geom.h"
+
+#define RAY_COUNT       256
+#define FIELD_SIZE      1000.0f
+
+typedef struct BoxField {
+    std::vector<AABB>   aabbs;
+    std::vector<OBB>    obbs;       // World space, the way RaycastBounds gets them from MultWorld
+    std::vector<Ray>    rays;
+} BoxField;
+
+static uint32_t g_seed;
+
+static float Random( float lo, float hi )
+{
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((g_seed >> 8) * (1.0f / 16777216.0f));
+}
+
+// Rotation about a random axis plus a translation, column major
+static dmVMath::Matrix4 RandomWorld( const Vec3 &position )
+{
+    Vec3 axis = normalize(Vec3(Random(-1, 1), Random(-1, 1), Random(-1, 1)));
+    float angle = Random(0.0f, 6.2831853f);
+    float c = cosf(angle), s = sinf(angle), t = 1.0f - c;
+
+    dmVMath::Matrix4 m = dmVMath::Matrix4::identity();
+    m[0][0] = t * axis.x * axis.x + c;
+    m[0][1] = t * axis.x * axis.y + s * axis.z;
+    m[0][2] = t * axis.x * axis.z - s * axis.y;
+    m[1][0] = t * axis.x * axis.y - s * axis.z;
+    m[1][1] = t * axis.y * axis.y + c;
+    m[1][2] = t * axis.y * axis.z + s * axis.x;
+    m[2][0] = t * axis.x * axis.z + s * axis.y;
+    m[2][1] = t * axis.y * axis.z - s * axis.x;
+    m[2][2] = t * axis.z * axis.z + c;
+    m[3][0] = position.x;
+    m[3][1] = position.y;
+    m[3][2] = position.z;
+    return m;
+}
+
+// Built once per size. The AABB and OBB of a box share center and size.
+static const BoxField &GetBoxField( int count )
+{
+    static std::map<int, BoxField> fields;
+    std::map<int, BoxField>::iterator it = fields.find(count);
+    if( it != fields.end() ) return it->second;
+
+    BoxField &field = fields[count];
+    g_seed = (uint32_t)count;
+    for( int i=0; i<count; ++i )
+    {
+        Vec3 half(Random(0.5f, 5.0f), Random(0.5f, 5.0f), Random(0.5f, 5.0f));
+        Vec3 center(Random(0, FIELD_SIZE), Random(0, FIELD_SIZE), Random(0, FIELD_SIZE));
+        field.aabbs.push_back(AABB(Vec3(center.x - half.x, center.y - half.y, center.z - half.z),
+                                   Vec3(center.x + half.x, center.y + half.y, center.z + half.z), i));
+
+        // Local min/max around the origin, placed by the world matrix (as addboundingbox + updateobb)
+        OBB obb;
+        obb.axis[0] = Vec3(-half.x, -half.y, -half.z);
+        obb.axis[1] = half;
+        obb.center = center;
+        obb.extents = half;
+        obb.tag = i;
+        obb.mat = RandomWorld(center);
+        field.obbs.push_back(obb);
+    }
+
+    for( int i=0; i<RAY_COUNT; ++i )
+    {
+        Vec3 origin(Random(0, FIELD_SIZE), Random(0, FIELD_SIZE), -100.0f);
+        Vec3 target(Random(0, FIELD_SIZE), Random(0, FIELD_SIZE), FIELD_SIZE + 100.0f);
+        field.rays.push_back(Ray(origin, normalize(Vec3(target.x - origin.x, target.y - origin.y, target.z - origin.z))));
+    }
+    return field;
+}
+
+// Puts the field's oriented boxes in the geom.cpp raycast list
+static void RegisterBoxField( const BoxField &field )
+{
+    ClearBounds();
+    for( size_t i=0; i<field.obbs.size(); ++i )
+    {
+        const OBB &obb = field.obbs[i];
+        int index = AddBounds(obb.axis[0], obb.axis[1], obb.tag);
+        SetBoundsWorld(index, obb.mat);
+    }
+}
+
+static void SetRayCounters( benchmark::State &state, size_t rays, size_t boxes )
+{
+    state.counters["rays/s"] = benchmark::Counter((double)rays, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["tests/s"] = benchmark::Counter((double)rays * boxes, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Brute force slab test against every axis aligned box
+static void BM_IntersectAABB( benchmark::State &state )
+{
+    const BoxField &field = GetBoxField((int)state.range(0));
+    for( auto _ : state )
+    {
+        int hits = 0;
+        for( size_t r=0; r<field.rays.size(); ++r )
+        {
+            float distance;
+            for( size_t b=0; b<field.aabbs.size(); ++b )
+                hits += intersect(field.rays[r], field.aabbs[b], &distance) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    SetRayCounters(state, field.rays.size(), field.aabbs.size());
+}
+
+// Brute force against every oriented box, without the per box MultWorld copy
+static void BM_IntersectOBB( benchmark::State &state )
+{
+    const BoxField &field = GetBoxField((int)state.range(0));
+    for( auto _ : state )
+    {
+        int hits = 0;
+        for( size_t r=0; r<field.rays.size(); ++r )
+        {
+            float distance;
+            for( size_t b=0; b<field.obbs.size(); ++b )
+                hits += intersectOBB(field.rays[r], field.obbs[b], &distance) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    SetRayCounters(state, field.rays.size(), field.obbs.size());
+}
+
+// The gltfloader.raycasttobox path: closest hit over the registered boxes
+static void BM_RaycastBounds( benchmark::State &state )
+{
+    const BoxField &field = GetBoxField((int)state.range(0));
+    RegisterBoxField(field);
+    for( auto _ : state )
+    {
+        int hits = 0;
+        for( size_t r=0; r<field.rays.size(); ++r )
+        {
+            float closest;
+            hits += RaycastBounds(field.rays[r], &closest) >= 0 ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    SetRayCounters(state, field.rays.size(), field.aabbs.size());
+}
+
+// A 64x64 block of samples per iteration, range(0) is the octave count
+static void BM_Perlin2d( benchmark::State &state )
+{
+    int depth = (int)state.range(0);
+    for( auto _ : state )
+    {
+        float sum = 0.0f;
+        for( int y=0; y<64; ++y )
+            for( int x=0; x<64; ++x )
+                sum += perlin2d(x * 1.37f, y * 1.37f, 0.1f, depth);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["samples/s"] = benchmark::Counter(64.0 * 64.0, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK(BM_IntersectAABB)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_IntersectOBB)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RaycastBounds)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Perlin2d)->Arg(1)->Arg(4)->Arg(8)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,391 @@
+// gltfbake - converts .gltf/.glb files into the baked runtime format (.bake)
+//
+//   gltfbake [options] <file or directory> ...
+//     -o <dir>          write the .bake files here instead of next to the sources, a
+//                       file found in a directory argument keeps its path below it
+//     -j <threads>      files baked in parallel (default: one per core)
+//     -q <bits>         quantize vertex streams to a 2^bits grid and weld (default: off)
+//     -l <r1,r2,...>    simplified lods, fraction of triangles kept per level
+//     -n                no vertex cache/fetch optimization
+//     -r                recurse into directories
+//
+// A .bake next to its source is picked up by load_gltf as long as the source and
+// the files it references still hash the same, so bakes can be copied or checked
+// in. They are flagged as tool made, load_gltf never replaces them with its own.
+// load_gltf reads them through the resource system, so a bake next to a model in a
+// custom_resources folder is used by bundled games as well as development runs.
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tiny_gltf.h"
+#include "gltf_parse.h"
+#include "jobs.h"
+#include "mesh.h"
+#include "mesh_cache.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+
+typedef struct BakeOptions {
+    std::string             outdir;
+    uint32_t                threads;
+    int                     quantizebits;
+    std::vector<float>      lods;
+    bool                    optimize;
+    bool                    recursive;
+} BakeOptions;
+
+typedef struct BakeJob {
+    const BakeOptions               *options;
+    const std::vector<std::string>  *files;
+    const std::vector<std::string>  *outputs;       // Per file, see GetOutputPath
+    std::vector<std::string>        errors;         // Per file, empty on success
+    std::atomic<uint32_t>           done;
+    std::atomic<uint64_t>           bytesin;
+    std::atomic<uint64_t>           bytesout;
+} BakeJob;
+
+static void Usage()
+{
+    printf("usage: gltfbake [-o dir] [-j threads] [-q bits] [-l r1,r2,...] [-n] [-r] <file or dir> ...\n");
+}
+
+static bool HasExtension( const std::string &path, const char *ext )
+{
+    size_t len = strlen(ext);
+    return path.size() > len && strcasecmp(path.c_str() + path.size() - len, ext) == 0;
+}
+
+static bool IsGltf( const std::string &path )
+{
+    return HasExtension(path, ".gltf") || HasExtension(path, ".glb");
+}
+
+// relative is the path of each file below the directory argument it was found in,
+// or just its name when it was passed directly
+static void CollectFiles( const std::string &path, const std::string &relpath, bool recursive, bool top,
+                          std::vector<std::string> &out, std::vector<std::string> &relative )
+{
+    struct stat st;
+    if( stat(path.c_str(), &st) != 0 )
+    {
+        fprintf(stderr, "gltfbake: %s not found\n", path.c_str());
+        return;
+    }
+    if( !S_ISDIR(st.st_mode) )
+    {
+        if( IsGltf(path) )
+        {
+            size_t slash = path.find_last_of('/');
+            out.push_back(path);
+            relative.push_back(top ? path.substr(slash == std::string::npos ? 0 : slash + 1) : relpath);
+        }
+        return;
+    }
+    if( !top && !recursive ) return;
+
+    DIR *dir = opendir(path.c_str());
+    if( !dir ) return;
+    while( struct dirent *entry = readdir(dir) )
+    {
+        if( entry->d_name[0] == '.' ) continue;
+        std::string name = entry->d_name;
+        CollectFiles(path + "/" + name, top ? name : relpath + "/" + name, recursive, false, out, relative);
+    }
+    closedir(dir);
+}
+
+// Next to the source, or the source's relative path mirrored under -o so that
+// a/scene.gltf and b/scene.gltf don't end up on the same .bake
+static std::string GetOutputPath( const BakeOptions &options, const std::string &source, const std::string &relative )
+{
+    if( options.outdir.empty() ) return GetMeshCachePath(source.c_str());
+    return GetMeshCachePath((options.outdir + "/" + relative).c_str());
+}
+
+// Unit length xyz, a tangent keeps its w (handedness)
+static void RenormalizeStream( MeshData &mesh, const char *name )
+{
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        MeshStream &stream = mesh.streams[s];
+        if( stream.name != name || stream.components < 3 ) continue;
+        for( size_t v=0; v<mesh.vertexcount; ++v )
+        {
+            float *n = &stream.data[v * stream.components];
+            float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if( len <= 0.0f ) continue;
+            float inv = 1.0f / len;
+            n[0] *= inv; n[1] *= inv; n[2] *= inv;
+        }
+    }
+}
+
+// Snaps every stream to a 2^bits grid over its own range, then welds the vertices
+// that became identical and drops the triangles the weld collapsed. The streams
+// stay float32 (the temp001.buffer layout), the gain is fewer vertices and data
+// that compresses well in the archive. Normals and tangents are renormalized
+// after the snap.
+static void QuantizeMesh( MeshData &mesh, int bits )
+{
+    if( mesh.vertexcount == 0 ) return;
+    float steps = (float)((1u << bits) - 1);
+
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+    {
+        MeshStream &stream = mesh.streams[s];
+        for( int c=0; c<stream.components; ++c )
+        {
+            float vmin = stream.data[c], vmax = stream.data[c];
+            for( size_t v=1; v<mesh.vertexcount; ++v )
+            {
+                float x = stream.data[v * stream.components + c];
+                if( x < vmin ) vmin = x;
+                if( x > vmax ) vmax = x;
+            }
+            float range = vmax - vmin;
+            if( range <= 0.0f ) continue;
+            float scale = steps / range;
+            for( size_t v=0; v<mesh.vertexcount; ++v )
+            {
+                float &x = stream.data[v * stream.components + c];
+                x = vmin + floorf((x - vmin) * scale + 0.5f) / scale;
+            }
+        }
+    }
+    RenormalizeStream(mesh, "normal");
+    RenormalizeStream(mesh, "tangent");
+
+    // Weld on the exact bytes of all streams
+    std::unordered_map<std::string, uint32_t> unique;
+    unique.reserve(mesh.vertexcount);
+    std::vector<uint32_t> remap(mesh.vertexcount);
+    std::string key;
+    size_t count = 0;
+    for( size_t v=0; v<mesh.vertexcount; ++v )
+    {
+        key.clear();
+        for( size_t s=0; s<mesh.streams.size(); ++s )
+        {
+            const MeshStream &stream = mesh.streams[s];
+            key.append((const char *)&stream.data[v * stream.components], stream.components * sizeof(float));
+        }
+        std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> it = unique.insert(std::make_pair(key, (uint32_t)count));
+        remap[v] = it.first->second;
+        if( !it.second ) continue;
+
+        // Compact in place, the slot written is never ahead of the one read
+        for( size_t s=0; s<mesh.streams.size(); ++s )
+        {
+            MeshStream &stream = mesh.streams[s];
+            memmove(&stream.data[count * stream.components], &stream.data[v * stream.components], stream.components * sizeof(float));
+        }
+        count++;
+    }
+
+    // Triangles with two corners welded together have no area left
+    size_t indexcount = 0;
+    for( size_t i=0; i+2<mesh.indices.size(); i+=3 )
+    {
+        uint32_t a = remap[mesh.indices[i]], b = remap[mesh.indices[i + 1]], c = remap[mesh.indices[i + 2]];
+        if( a == b || b == c || a == c ) continue;
+        mesh.indices[indexcount++] = a;
+        mesh.indices[indexcount++] = b;
+        mesh.indices[indexcount++] = c;
+    }
+    mesh.indices.resize(indexcount);
+    for( size_t s=0; s<mesh.streams.size(); ++s )
+        mesh.streams[s].data.resize(count * mesh.streams[s].components);
+    mesh.vertexcount = count;
+}
+
+static bool BakeFile( const BakeOptions &options, const std::string &source, const std::string &outpath,
+                      std::string *err, uint64_t *bytesout )
+{
+    tinygltf::Model model;
+    std::string warn;
+    if( !ParseGltf(source.c_str(), LOAD_NO_CACHE, model, err, &warn, 0, 0) )
+    {
+        if( err->empty() ) *err = "Failed to parse glTF";
+        return false;
+    }
+
+    std::vector<BakeMesh> meshes;
+    if( !CollectBakeMeshes(model, meshes) )
+    {
+        *err = "A primitive could not be converted to a triangle list";
+        return false;
+    }
+
+    size_t basecount = meshes.size();
+    for( size_t i=0; i<basecount; ++i )
+    {
+        if( options.quantizebits > 0 )
+        {
+            QuantizeMesh(meshes[i].data, options.quantizebits);
+            if( meshes[i].data.indices.empty() )
+            {
+                *err = "Quantizing collapsed every triangle of a primitive, use more bits";
+                return false;
+            }
+        }
+        if( options.optimize ) OptimizeMesh(meshes[i].data, 0);
+
+        for( size_t l=0; l<options.lods.size(); ++l )
+        {
+            BakeMesh lod;
+            lod.mesh = meshes[i].mesh;
+            lod.primitive = meshes[i].primitive;
+            lod.lod = (int)l + 1;
+            if( SimplifyMesh(meshes[i].data, options.lods[l], lod.data) == 0 ) continue;
+            if( options.optimize ) OptimizeMesh(lod.data, 0);
+            meshes.push_back(lod);
+        }
+    }
+
+    if( !WriteMeshCache(model, meshes, outpath.c_str(), source.c_str(), BAKE_FLAG_TOOL, err) )
+        return false;
+
+    struct stat st;
+    if( stat(outpath.c_str(), &st) == 0 ) *bytesout = st.st_size;
+    return true;
+}
+
+static void BakeOne( void *ctx, uint32_t index )
+{
+    BakeJob *job = (BakeJob *)ctx;
+    const std::string &source = (*job->files)[index];
+
+    std::string err;
+    uint64_t bytesout = 0;
+    if( !BakeFile(*job->options, source, (*job->outputs)[index], &err, &bytesout) )
+    {
+        job->errors[index] = err.empty() ? "unknown error" : err;
+        fprintf(stderr, "gltfbake: %s: %s\n", source.c_str(), job->errors[index].c_str());
+    }
+    else
+    {
+        struct stat st;
+        if( stat(source.c_str(), &st) == 0 ) job->bytesin += st.st_size;
+        job->bytesout += bytesout;
+    }
+
+    uint32_t done = ++job->done;
+    printf("[%u/%u] %s\n", done, (uint32_t)job->files->size(), source.c_str());
+}
+
+static bool ParseLods( const char *arg, std::vector<float> &lods )
+{
+    const char *p = arg;
+    while( *p )
+    {
+        char *end = 0;
+        float ratio = strtof(p, &end);
+        if( end == p || ratio <= 0.0f || ratio >= 1.0f ) return false;
+        lods.push_back(ratio);
+        p = (*end == ',') ? end + 1 : end;
+        if( *end != ',' && *end != 0 ) return false;
+    }
+    return !lods.empty();
+}
+
+int main( int argc, char **argv )
+{
+    BakeOptions options;
+    options.threads = 0;
+    options.quantizebits = 0;
+    options.optimize = true;
+    options.recursive = false;
+
+    std::vector<std::string> inputs;
+    for( int i=1; i<argc; ++i )
+    {
+        const char *arg = argv[i];
+        bool hasvalue = i + 1 < argc;
+        if( strcmp(arg, "-o") == 0 && hasvalue ) options.outdir = argv[++i];
+        else if( strcmp(arg, "-j") == 0 && hasvalue ) options.threads = (uint32_t)atoi(argv[++i]);
+        else if( strcmp(arg, "-q") == 0 && hasvalue ) options.quantizebits = atoi(argv[++i]);
+        else if( strcmp(arg, "-l") == 0 && hasvalue )
+        {
+            if( !ParseLods(argv[++i], options.lods) )
+            {
+                fprintf(stderr, "gltfbake: lods are ratios between 0 and 1, like 0.5,0.25\n");
+                return 1;
+            }
+        }
+        else if( strcmp(arg, "-n") == 0 ) options.optimize = false;
+        else if( strcmp(arg, "-r") == 0 ) options.recursive = true;
+        else if( strcmp(arg, "-h") == 0 || arg[0] == '-' ) { Usage(); return arg[1] == 'h' ? 0 : 1; }
+        else
+        {
+            std::string input = arg;
+            while( input.size() > 1 && input[input.size() - 1] == '/' ) input.erase(input.size() - 1);
+            inputs.push_back(input);
+        }
+    }
+    if( inputs.empty() ) { Usage(); return 1; }
+    if( options.quantizebits < 0 || options.quantizebits > 24 )
+    {
+        fprintf(stderr, "gltfbake: quantization is 1 to 24 bits\n");
+        return 1;
+    }
+
+    std::vector<std::string> files, relative;
+    for( size_t i=0; i<inputs.size(); ++i )
+        CollectFiles(inputs[i], "", options.recursive, true, files, relative);
+    if( files.empty() )
+    {
+        fprintf(stderr, "gltfbake: no .gltf/.glb files found\n");
+        return 1;
+    }
+
+    // Two jobs writing the same .bake would race on its .tmp, refuse before any starts
+    std::vector<std::string> outputs(files.size());
+    std::unordered_map<std::string, size_t> owners;
+    for( size_t i=0; i<files.size(); ++i )
+    {
+        outputs[i] = GetOutputPath(options, files[i], relative[i]);
+        std::pair<std::unordered_map<std::string, size_t>::iterator, bool> it = owners.insert(std::make_pair(outputs[i], i));
+        if( !it.second )
+        {
+            fprintf(stderr, "gltfbake: %s and %s both bake to %s\n",
+                    files[it.first->second].c_str(), files[i].c_str(), outputs[i].c_str());
+            return 1;
+        }
+    }
+
+    if( options.threads ) SetJobThreadCount(options.threads);
+
+    BakeJob job;
+    job.options = &options;
+    job.files = &files;
+    job.outputs = &outputs;
+    job.errors.resize(files.size());
+    job.done = 0;
+    job.bytesin = 0;
+    job.bytesout = 0;
+
+    uint32_t threads = GetJobThreadCount();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ParallelFor((uint32_t)files.size(), BakeOne, &job);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ShutdownJobs();
+
+    uint32_t failed = 0;
+    for( size_t i=0; i<job.errors.size(); ++i )
+        failed += job.errors[i].empty() ? 0 : 1;
+
+    printf("Baked %u of %u files in %.2f s on %u threads (%.1f MB -> %.1f MB)\n",
+           (uint32_t)files.size() - failed, (uint32_t)files.size(), seconds, threads,
+           job.bytesin / (1024.0 * 1024.0), job.bytesout / (1024.0 * 1024.0));
+    return failed ? 2 : 0;
+}
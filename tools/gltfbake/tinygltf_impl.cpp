@@ -0,0 +1,6 @@
+// tinygltf/stb implementation for the tools. The extension gets it from
+// tinygltf_loader.cpp, which needs the Defold SDK.
+#define TINYGLTF_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "tiny_gltf.h"
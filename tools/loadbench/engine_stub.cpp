@@ -0,0 +1,15 @@
+// The parts of the extension and engine the loader links against but the
+// benchmarks never reach. The mesh pool needs a running collection.
+#include "mesh_pool.h"
+
+// The engine ships stb_image, tinygltf_loader.cpp only adds stb_image_write
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+void InitMeshPool( dmGameObject::HCollection, dmGameSystem::HFactoryWorld, dmGameSystem::HFactoryComponent, dmConfigFile::HConfig )
+{
+}
+
+void DestroyMeshPool()
+{
+}
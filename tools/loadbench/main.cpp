@@ -0,0 +1,261 @@
+// loadbench - times load_gltf on synthetic and real models, results as JSON
+//
+//   loadbench [options] [model.gltf ...]
+//     -n <iterations>   timed loads per model (default 5)
+//     -w <warmup>       untimed loads before those (default 1)
+//     -o <file>         where the JSON goes (default loadbench.json, - for stdout)
+//     -t <label>        stored with the results, e.g. the commit being measured
+//     -r <root>         repo root the real models are found in (default ../..)
+//     -c                use the .bake cache (the default is LOAD_NO_CACHE)
+//     -l                lazy images (LOAD_LAZY_IMAGES), no decode time
+//     -s                skip the synthetic models
+//
+// Without model arguments the real models from the repo are loaded as well,
+// the ones that are missing show up with an "error" in the results.
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "tinygltf_loader.h"
+#include "jobs.h"
+#include "synthetic.h"
+
+// The two models main.script switches between
+static const char *g_realmodels[] = {
+    "assets/models/low_poly_zombies/scene.gltf",
+    "assets/models/japanese_sedan_86/japanese_sedan_86.glb",
+};
+
+typedef struct BenchModel {
+    std::string         name;
+    std::string         path;
+    bool                synthetic;
+} BenchModel;
+
+// Per iteration, in microseconds
+typedef struct BenchSamples {
+    std::vector<uint64_t>   parse;
+    std::vector<uint64_t>   buffer;
+    std::vector<uint64_t>   image;
+    std::vector<uint64_t>   total;
+} BenchSamples;
+
+static void Usage()
+{
+    fprintf(stderr, "usage: loadbench [-n iterations] [-w warmup] [-o file] [-t label] [-r root] [-c] [-l] [-s] [model.gltf ...]\n");
+}
+
+// Resets the peak RSS so each model gets its own (Linux 4.0+). Without it the
+// reported peak is the one of the whole process so far.
+static bool ResetPeakRss()
+{
+    FILE *file = fopen("/proc/self/clear_refs", "w");
+    if( !file ) return false;
+    bool ok = fputs("5", file) >= 0;
+    return fclose(file) == 0 && ok;
+}
+
+static uint64_t GetPeakRssKb()
+{
+    FILE *file = fopen("/proc/self/status", "r");
+    if( file )
+    {
+        char line[256];
+        unsigned long long kb = 0;
+        bool found = false;
+        while( !found && fgets(line, sizeof(line), file) )
+            found = sscanf(line, "VmHWM: %llu kB", &kb) == 1;
+        fclose(file);
+        if( found ) return kb;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_maxrss;
+}
+
+static int RemoveEntry( const char *path, const struct stat *, int, struct FTW * )
+{
+    return remove(path);
+}
+
+static std::string JsonString( const std::string &text )
+{
+    std::string out = "\"";
+    for( size_t i=0; i<text.size(); ++i )
+    {
+        char c = text[i];
+        if( c == '"' || c == '\\' ) { out += '\\'; out += c; }
+        else if( (unsigned char)c < 0x20 ) { char hex[8]; snprintf(hex, sizeof(hex), "\\u%04x", c); out += hex; }
+        else out += c;
+    }
+    return out + "\"";
+}
+
+// min / median / mean in milliseconds
+static std::string JsonTimes( std::vector<uint64_t> samples )
+{
+    std::sort(samples.begin(), samples.end());
+    uint64_t sum = 0;
+    for( size_t i=0; i<samples.size(); ++i )
+        sum += samples[i];
+    size_t count = samples.size();
+    double median = (count & 1) ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) * 0.5;
+    char text[128];
+    snprintf(text, sizeof(text), "{\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f}",
+             samples[0] / 1000.0, median / 1000.0, (double)sum / count / 1000.0);
+    return text;
+}
+
+// Loads the model warmup + iterations times, returns the JSON object for it
+static std::string BenchOne( const BenchModel &bench, int iterations, int warmup, uint32_t flags )
+{
+    std::string json = "{\"name\":" + JsonString(bench.name) + ",\"path\":" + JsonString(bench.path);
+    json += bench.synthetic ? ",\"synthetic\":true" : ",\"synthetic\":false";
+
+    if( access(bench.path.c_str(), R_OK) != 0 )
+        return json + ",\"error\":\"not found\"}";
+
+    bool rssreset = ResetPeakRss();
+    BenchSamples samples;
+    LoadTimings last;
+    size_t meshes = 0, images = 0;
+    for( int i=0; i<warmup + iterations; ++i )
+    {
+        int modelid = load_gltf(bench.path.c_str(), false, flags);
+        DefoldModel *model = GetDefoldModel(modelid);
+        if( !model )
+        {
+            ClearModels();
+            return json + ",\"error\":\"load failed\"}";
+        }
+        last = model->timings;
+        meshes = model->model.meshes.size();
+        images = model->model.images.size();
+        ClearModels();
+        if( i < warmup ) continue;
+
+        samples.parse.push_back(last.parse.total - last.parse.read);
+        samples.buffer.push_back(last.parse.read);
+        samples.image.push_back(last.images);
+        samples.total.push_back(last.total);
+    }
+
+    char text[256];
+    snprintf(text, sizeof(text), ",\"iterations\":%d,\"cached\":%s,\"meshes\":%zu,\"images\":%zu,\"bytes_read\":%llu",
+             iterations, last.cached ? "true" : "false", meshes, images, (unsigned long long)last.parse.bytesread);
+    json += text;
+    json += ",\"parse_ms\":" + JsonTimes(samples.parse);
+    json += ",\"buffer_ms\":" + JsonTimes(samples.buffer);
+    json += ",\"image_ms\":" + JsonTimes(samples.image);
+    json += ",\"total_ms\":" + JsonTimes(samples.total);
+    snprintf(text, sizeof(text), ",\"peak_rss_kb\":%llu,\"peak_rss_per_model\":%s}",
+             (unsigned long long)GetPeakRssKb(), rssreset ? "true" : "false");
+    return json + text;
+}
+
+int main( int argc, char **argv )
+{
+    int iterations = 5;
+    int warmup = 1;
+    uint32_t flags = LOAD_NO_CACHE;
+    bool synthetic = true;
+    std::string output = "loadbench.json";
+    std::string label;
+    std::string root = "../..";
+    std::vector<BenchModel> models;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const char *arg = argv[i];
+        bool hasvalue = i + 1 < argc;
+        if( strcmp(arg, "-n") == 0 && hasvalue ) iterations = atoi(argv[++i]);
+        else if( strcmp(arg, "-w") == 0 && hasvalue ) warmup = atoi(argv[++i]);
+        else if( strcmp(arg, "-o") == 0 && hasvalue ) output = argv[++i];
+        else if( strcmp(arg, "-t") == 0 && hasvalue ) label = argv[++i];
+        else if( strcmp(arg, "-r") == 0 && hasvalue ) root = argv[++i];
+        else if( strcmp(arg, "-c") == 0 ) flags &= ~LOAD_NO_CACHE;
+        else if( strcmp(arg, "-l") == 0 ) flags |= LOAD_LAZY_IMAGES;
+        else if( strcmp(arg, "-s") == 0 ) synthetic = false;
+        else if( arg[0] == '-' ) { Usage(); return strcmp(arg, "-h") == 0 ? 0 : 1; }
+        else
+        {
+            BenchModel model = { arg, arg, false };
+            models.push_back(model);
+        }
+    }
+    if( iterations < 1 || warmup < 0 )
+    {
+        Usage();
+        return 1;
+    }
+
+    if( models.empty() )
+    {
+        for( size_t i=0; i<sizeof(g_realmodels) / sizeof(g_realmodels[0]); ++i )
+        {
+            BenchModel model = { g_realmodels[i], root + "/" + g_realmodels[i], false };
+            models.push_back(model);
+        }
+    }
+
+    // The synthetic models are written fresh for every run
+    char tempdir[] = "/tmp/loadbench.XXXXXX";
+    bool havetemp = false;
+    if( synthetic )
+    {
+        if( !mkdtemp(tempdir) )
+        {
+            fprintf(stderr, "loadbench: could not create a temporary directory\n");
+            return 1;
+        }
+        havetemp = true;
+
+        const std::vector<SyntheticModel> &descs = GetSyntheticModels();
+        for( size_t i=0; i<descs.size(); ++i )
+        {
+            std::string err;
+            std::string path = WriteSyntheticModel(descs[i], tempdir, &err);
+            if( path.empty() )
+            {
+                fprintf(stderr, "loadbench: %s\n", err.c_str());
+                continue;
+            }
+            BenchModel model = { descs[i].name, path, true };
+            models.insert(models.begin() + i, model);
+        }
+    }
+
+    std::string json = "{\"benchmark\":\"load_gltf\",\"label\":" + JsonString(label);
+    char text[128];
+    snprintf(text, sizeof(text), ",\"iterations\":%d,\"warmup\":%d,\"flags\":%u,\"threads\":%u,\"models\":[",
+             iterations, warmup, flags, GetJobThreadCount());
+    json += text;
+
+    for( size_t i=0; i<models.size(); ++i )
+    {
+        fprintf(stderr, "[%zu/%zu] %s\n", i + 1, models.size(), models[i].name.c_str());
+        json += (i ? "," : "") + BenchOne(models[i], iterations, warmup, flags);
+    }
+    json += "]}\n";
+    ShutdownJobs();
+
+    if( havetemp )
+        nftw(tempdir, RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+
+    FILE *file = output == "-" ? stdout : fopen(output.c_str(), "w");
+    if( !file )
+    {
+        fprintf(stderr, "loadbench: could not write %s\n", output.c_str());
+        return 1;
+    }
+    fputs(json.c_str(), file);
+    if( file != stdout ) fclose(file);
+    return 0;
+}
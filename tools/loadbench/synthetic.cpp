@@ -0,0 +1,217 @@
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "stb_image_write.h"
+#include "synthetic.h"
+
+static const std::vector<SyntheticModel> g_models = {
+    // name              meshes  grid  images  size  buffer
+    { "grid_small",      1,      64,   0,      0,    SYNTHETIC_EXTERNAL },
+    { "grid_large",      1,      512,  0,      0,    SYNTHETIC_EXTERNAL },
+    { "grid_embedded",   1,      256,  0,      0,    SYNTHETIC_EMBEDDED },
+    { "grid_glb",        1,      256,  0,      0,    SYNTHETIC_GLB },
+    { "many_nodes",      2000,   4,    0,      0,    SYNTHETIC_EXTERNAL },
+    { "textured",        8,      32,   8,      1024, SYNTHETIC_EXTERNAL },
+};
+
+const std::vector<SyntheticModel> &GetSyntheticModels()
+{
+    return g_models;
+}
+
+static void Append( std::vector<unsigned char> &bin, const void *data, size_t size )
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    bin.insert(bin.end(), bytes, bytes + size);
+}
+
+static std::string Format( const char *format, ... ) __attribute__((format(printf, 1, 2)));
+static std::string Format( const char *format, ... )
+{
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return text;
+}
+
+static std::string Base64( const std::vector<unsigned char> &data )
+{
+    static const char *table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    for( size_t i=0; i<data.size(); i+=3 )
+    {
+        uint32_t n = (uint32_t)data[i] << 16;
+        if( i + 1 < data.size() ) n |= (uint32_t)data[i + 1] << 8;
+        if( i + 2 < data.size() ) n |= data[i + 2];
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += (i + 1 < data.size()) ? table[(n >> 6) & 63] : '=';
+        out += (i + 2 < data.size()) ? table[n & 63] : '=';
+    }
+    return out;
+}
+
+// A gradient with some noise on top, so the png compresses like a real texture would
+static bool WriteImage( const std::string &path, int size, uint32_t seed )
+{
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    uint32_t state = seed * 2654435761u + 1;
+    for( int y=0; y<size; ++y )
+    {
+        for( int x=0; x<size; ++x )
+        {
+            state = state * 1664525u + 1013904223u;
+            unsigned char *p = &pixels[((size_t)y * size + x) * 4];
+            p[0] = (unsigned char)(x * 255 / size) ^ (unsigned char)(state >> 28);
+            p[1] = (unsigned char)(y * 255 / size) ^ (unsigned char)(state >> 24 & 15);
+            p[2] = (unsigned char)(seed * 37);
+            p[3] = 255;
+        }
+    }
+    return stbi_write_png(path.c_str(), size, size, 4, pixels.data(), size * 4) != 0;
+}
+
+static bool WriteFile( const std::string &path, const void *data, size_t size )
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if( !file ) return false;
+    bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+std::string WriteSyntheticModel( const SyntheticModel &desc, const std::string &dir, std::string *err )
+{
+    std::vector<unsigned char> bin;
+    std::string views, accessors, meshes, nodes, scenenodes;
+
+    int n = desc.gridsize;
+    uint32_t vertexcount = (uint32_t)(n + 1) * (n + 1);
+    uint32_t indexcount = (uint32_t)n * n * 6;
+    for( int m=0; m<desc.meshes; ++m )
+    {
+        std::vector<float> positions, normals, texcoords;
+        positions.reserve(vertexcount * 3);
+        normals.reserve(vertexcount * 3);
+        texcoords.reserve(vertexcount * 2);
+        for( int y=0; y<=n; ++y )
+        {
+            for( int x=0; x<=n; ++x )
+            {
+                float u = (float)x / n, v = (float)y / n;
+                positions.push_back(u);
+                positions.push_back(0.0f);
+                positions.push_back(v);
+                normals.push_back(0.0f);
+                normals.push_back(1.0f);
+                normals.push_back(0.0f);
+                texcoords.push_back(u);
+                texcoords.push_back(v);
+            }
+        }
+        std::vector<uint32_t> indices;
+        indices.reserve(indexcount);
+        for( int y=0; y<n; ++y )
+        {
+            for( int x=0; x<n; ++x )
+            {
+                uint32_t a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+                uint32_t quad[6] = { a, c, b, b, c, d };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+
+        const void *data[4] = { positions.data(), normals.data(), texcoords.data(), indices.data() };
+        size_t sizes[4] = { positions.size() * 4, normals.size() * 4, texcoords.size() * 4, indices.size() * 4 };
+        int first = m * 4;
+        for( int i=0; i<4; ++i )
+        {
+            views += Format("%s{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}", views.empty() ? "" : ",", bin.size(), sizes[i]);
+            Append(bin, data[i], sizes[i]);
+        }
+        accessors += Format("%s{\"bufferView\":%d,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[1,0,1]}",
+                            accessors.empty() ? "" : ",", first, vertexcount);
+        accessors += Format(",{\"bufferView\":%d,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"}", first + 1, vertexcount);
+        accessors += Format(",{\"bufferView\":%d,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"}", first + 2, vertexcount);
+        accessors += Format(",{\"bufferView\":%d,\"componentType\":5125,\"count\":%u,\"type\":\"SCALAR\"}", first + 3, indexcount);
+
+        std::string material = desc.images ? Format(",\"material\":%d", m % desc.images) : "";
+        meshes += Format("%s{\"name\":\"mesh%d\",\"primitives\":[{\"attributes\":{\"POSITION\":%d,\"NORMAL\":%d,\"TEXCOORD_0\":%d},\"indices\":%d%s}]}",
+                         meshes.empty() ? "" : ",", m, first, first + 1, first + 2, first + 3, material.c_str());
+        nodes += Format("%s{\"name\":\"node%d\",\"mesh\":%d,\"translation\":[%d,0,%d]}", nodes.empty() ? "" : ",", m, m, m % 64, m / 64);
+        scenenodes += Format("%s%d", scenenodes.empty() ? "" : ",", m);
+    }
+
+    std::string images, textures, materials;
+    for( int i=0; i<desc.images; ++i )
+    {
+        std::string file = Format("%s_%d.png", desc.name, i);
+        if( !WriteImage(dir + "/" + file, desc.imagesize, i) )
+        {
+            *err = "Failed to write " + file;
+            return "";
+        }
+        const char *sep = i ? "," : "";
+        images += Format("%s{\"uri\":\"%s\"}", sep, file.c_str());
+        textures += Format("%s{\"source\":%d}", sep, i);
+        materials += Format("%s{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":%d}}}", sep, i);
+    }
+
+    std::string buffer;
+    std::string ext = desc.buffer == SYNTHETIC_GLB ? ".glb" : ".gltf";
+    std::string path = dir + "/" + desc.name + ext;
+    if( desc.buffer == SYNTHETIC_EXTERNAL )
+    {
+        std::string binfile = std::string(desc.name) + ".bin";
+        if( !WriteFile(dir + "/" + binfile, bin.data(), bin.size()) )
+        {
+            *err = "Failed to write " + binfile;
+            return "";
+        }
+        buffer = Format("{\"byteLength\":%zu,\"uri\":\"%s\"}", bin.size(), binfile.c_str());
+    }
+    else if( desc.buffer == SYNTHETIC_EMBEDDED )
+        buffer = Format("{\"byteLength\":%zu,\"uri\":\"data:application/octet-stream;base64,", bin.size()) + Base64(bin) + "\"}";
+    else
+        buffer = Format("{\"byteLength\":%zu}", bin.size());
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"loadbench\"},\"scene\":0,\"scenes\":[{\"nodes\":[" + scenenodes + "]}]";
+    json += ",\"nodes\":[" + nodes + "],\"meshes\":[" + meshes + "]";
+    json += ",\"buffers\":[" + buffer + "],\"bufferViews\":[" + views + "],\"accessors\":[" + accessors + "]";
+    if( desc.images )
+        json += ",\"images\":[" + images + "],\"textures\":[" + textures + "],\"materials\":[" + materials + "]";
+    json += "}";
+
+    bool ok;
+    if( desc.buffer == SYNTHETIC_GLB )
+    {
+        // Both chunks padded to 4 bytes, json with spaces and the binary chunk with zeros
+        while( json.size() % 4 ) json += ' ';
+        while( bin.size() % 4 ) bin.push_back(0);
+        std::vector<unsigned char> glb;
+        uint32_t header[3] = { 0x46546C67, 2, (uint32_t)(12 + 8 + json.size() + 8 + bin.size()) };
+        uint32_t jsonchunk[2] = { (uint32_t)json.size(), 0x4E4F534A };
+        uint32_t binchunk[2] = { (uint32_t)bin.size(), 0x004E4942 };
+        Append(glb, header, sizeof(header));
+        Append(glb, jsonchunk, sizeof(jsonchunk));
+        Append(glb, json.data(), json.size());
+        Append(glb, binchunk, sizeof(binchunk));
+        Append(glb, bin.data(), bin.size());
+        ok = WriteFile(path, glb.data(), glb.size());
+    }
+    else
+        ok = WriteFile(path, json.data(), json.size());
+
+    if( !ok )
+    {
+        *err = "Failed to write " + path;
+        return "";
+    }
+    return path;
+}
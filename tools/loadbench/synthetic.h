@@ -0,0 +1,30 @@
+#ifndef _SYNTHETIC_HEADER_
+#define _SYNTHETIC_HEADER_
+
+#include <string>
+#include <vector>
+
+// How a synthetic model stores its vertex data
+enum SyntheticBuffer
+{
+    SYNTHETIC_EXTERNAL,     // .gltf + .bin
+    SYNTHETIC_EMBEDDED,     // .gltf with a base64 data uri
+    SYNTHETIC_GLB,          // binary chunk of a .glb
+};
+
+typedef struct SyntheticModel {
+    const char          *name;
+    int                 meshes;         // One node per mesh
+    int                 gridsize;       // Quads per side of each mesh (a grid of (n+1)^2 vertices)
+    int                 images;         // PNG files referenced by the materials
+    int                 imagesize;
+    SyntheticBuffer     buffer;
+} SyntheticModel;
+
+// The default set, from small to large
+const std::vector<SyntheticModel> &GetSyntheticModels();
+
+// Writes the model into dir, returns the path of the .gltf/.glb
+std::string WriteSyntheticModel( const SyntheticModel &desc, const std::string &dir, std::string *err );
+
+#endif // _SYNTHETIC_HEADER_
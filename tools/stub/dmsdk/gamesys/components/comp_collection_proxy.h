@@ -0,0 +1,6 @@
+#ifndef _DMSDK_STUB_COMP_COLLECTION_PROXY_HEADER_
+#define _DMSDK_STUB_COMP_COLLECTION_PROXY_HEADER_
+
+#include <dmsdk/sdk.h>
+
+#endif // _DMSDK_STUB_COMP_COLLECTION_PROXY_HEADER_
@@ -0,0 +1,12 @@
+#ifndef _DMSDK_STUB_COMP_FACTORY_HEADER_
+#define _DMSDK_STUB_COMP_FACTORY_HEADER_
+
+#include <dmsdk/sdk.h>
+
+namespace dmGameSystem
+{
+    typedef void *HFactoryWorld;
+    typedef void *HFactoryComponent;
+}
+
+#endif // _DMSDK_STUB_COMP_FACTORY_HEADER_
@@ -0,0 +1,135 @@
+// Just enough of the Defold SDK to build parts of the extension (the loader,
+// geom.cpp) on a plain Linux box for the tools and benchmarks. Nothing here
+// talks to an engine: resources are never found, game objects never exist and
+// there is no Lua VM, the bindings compile but are never called.
+#ifndef _DMSDK_STUB_SDK_HEADER_
+#define _DMSDK_STUB_SDK_HEADER_
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#define dmLogInfo(...)      (printf(__VA_ARGS__), printf("\n"))
+#define dmLogWarning(...)   (printf(__VA_ARGS__), printf("\n"))
+#define dmLogError(...)     (printf(__VA_ARGS__), printf("\n"))
+
+// No profiler, scopes and counters compile to nothing
+#define DM_PROFILE(name)
+#define DM_PROPERTY_EXTERN(name)
+#define DM_PROPERTY_ADD_U32(name, value)
+
+typedef uint64_t dmhash_t;
+
+// FNV-1a, the values only have to be stable within a run
+inline dmhash_t dmHashString64( const char *string )
+{
+    dmhash_t hash = 14695981039346656037ULL;
+    while( *string ) hash = (hash ^ (unsigned char)*string++) * 1099511628211ULL;
+    return hash;
+}
+
+inline const char *dmHashReverseSafe64( dmhash_t )
+{
+    return "<unknown>";
+}
+
+#define DM_LUA_STACK_CHECK(L, diff)     (void)(L)
+#define DM_LUA_ERROR(...)               luaL_error(L, __VA_ARGS__)
+
+typedef struct lua_State lua_State;
+typedef double lua_Number;
+inline void lua_pushnil( lua_State * ) {}
+inline void lua_pushnumber( lua_State *, lua_Number ) {}
+inline lua_Number luaL_checknumber( lua_State *, int ) { return 0; }
+inline int luaL_error( lua_State *, const char *, ... ) { return 0; }
+
+namespace dmVMath
+{
+    struct Vector3
+    {
+        float v[3];
+        Vector3() { v[0] = v[1] = v[2] = 0.0f; }
+        Vector3( float x, float y, float z ) { v[0] = x; v[1] = y; v[2] = z; }
+        float operator[]( int i ) const { return v[i]; }
+        float &operator[]( int i ) { return v[i]; }
+    };
+
+    struct Vector4
+    {
+        float v[4];
+        Vector4() { v[0] = v[1] = v[2] = v[3] = 0.0f; }
+        Vector4( float x, float y, float z, float w ) { v[0] = x; v[1] = y; v[2] = z; v[3] = w; }
+        float operator[]( int i ) const { return v[i]; }
+        float &operator[]( int i ) { return v[i]; }
+    };
+
+    struct Point3 { float x, y, z; };
+    struct Quat   { float x, y, z, w; };
+
+    // Column major, mat[column][row] like vectormath
+    struct Matrix4
+    {
+        Vector4 col[4];
+        const Vector4 &operator[]( int i ) const { return col[i]; }
+        Vector4 &operator[]( int i ) { return col[i]; }
+        static Matrix4 identity()
+        {
+            Matrix4 m;
+            for( int i=0; i<4; ++i ) m.col[i][i] = 1.0f;
+            return m;
+        }
+    };
+}
+
+namespace dmScript
+{
+    inline dmVMath::Vector3 *CheckVector3( lua_State *, int ) { static dmVMath::Vector3 v; return &v; }
+    inline dmVMath::Matrix4 *CheckMatrix4( lua_State *, int ) { static dmVMath::Matrix4 m; return &m; }
+    inline dmhash_t CheckHash( lua_State *, int ) { return 0; }
+    inline void PushHash( lua_State *, dmhash_t ) {}
+    inline void PushVector3( lua_State *, const dmVMath::Vector3 & ) {}
+}
+
+namespace dmTime
+{
+    inline uint64_t GetMonotonicTime()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+}
+
+namespace dmConfigFile
+{
+    typedef void *HConfig;
+    inline const char *GetString( HConfig, const char *, const char *default_value ) { return default_value; }
+    inline int32_t GetInt( HConfig, const char *, int32_t default_value ) { return default_value; }
+    inline float GetFloat( HConfig, const char *, float default_value ) { return default_value; }
+}
+
+namespace dmResource
+{
+    typedef void *HFactory;
+    enum Result { RESULT_OK = 0, RESULT_RESOURCE_NOT_FOUND = -1 };
+    inline Result Get( HFactory, const char *, void ** ) { return RESULT_RESOURCE_NOT_FOUND; }
+    inline void Release( HFactory, void * ) {}
+    inline Result GetRaw( HFactory, const char *, void **, uint32_t * ) { return RESULT_RESOURCE_NOT_FOUND; }
+}
+
+namespace dmGameObject
+{
+    typedef struct CollectionHandle *HCollection;
+    typedef struct Instance *HInstance;
+    typedef void *HComponent;
+    typedef void *HComponentWorld;
+    enum Result { RESULT_OK = 0, RESULT_COMPONENT_NOT_FOUND = -1 };
+    inline HInstance GetInstanceFromIdentifier( HCollection, dmhash_t ) { return 0; }
+    inline Result GetComponent( HInstance, dmhash_t, uint32_t *, HComponent *, HComponentWorld * ) { return RESULT_COMPONENT_NOT_FOUND; }
+}
+
+#endif // _DMSDK_STUB_SDK_HEADER_